@@ -0,0 +1,139 @@
+/*
+** file: lard84_bench.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Per-stage benchmarks of the input pipeline.
+*/
+
+#include "lard84_bench.h"
+
+#include "lard84_debounce.h"
+#include "lard84_keycodes.h"
+#include "lard84_keyorder.h"
+#include "lard84_report.h"
+#include "lard84_socd.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Keeps the results of the measured calls alive
+static volatile uint32_t sink = 0;
+
+// Typing: a modifier and a few letters held, (col, row). LShift, A, S, D
+// and J in the default keymap; A and D are an SOCD pair.
+static const uint8_t held_keys[][2] = {{0, 4}, {1, 3}, {2, 3}, {3, 3}, {7, 3}};
+#define N_HELD_KEYS (sizeof(held_keys) / sizeof(held_keys[0]))
+
+static uint8_t held_col_rows[N_COLS] = {0};
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static void nop() {}
+
+static uint32_t batch_calls(const l84_bench_stage_t *stage) {
+  return (uint32_t)stage->batch * L84_BENCH_BATCH_SCALE;
+}
+
+static uint32_t time_batch(const l84_bench_stage_t *stage,
+                           l84_bench_counter_fn now, void (*run)()) {
+  uint32_t best = UINT32_MAX;
+  for (uint8_t rep = 0; rep < L84_BENCH_REPS; ++rep) {
+    if (stage->prepare)
+      stage->prepare();
+    uint32_t start = now();
+    for (uint32_t i = 0; i < batch_calls(stage); ++i) {
+      run();
+    }
+    uint32_t ticks = now() - start;
+    if (ticks < best)
+      best = ticks;
+  }
+  return best;
+}
+
+// Debounce: steady state with a few keys held, the common case
+static void debounce_setup() {
+  for (uint8_t i = 0; i < N_HELD_KEYS; ++i) {
+    held_col_rows[held_keys[i][0]] |= 1u << held_keys[i][1];
+  }
+  l84_debounce_reset();
+  l84_debounce_event_t events[L84_DEBOUNCE_MAX_EVENTS];
+  for (uint8_t i = 0; i <= L84_DEBOUNCE_THRESHOLD_SCANS; ++i) {
+    l84_debounce_update(held_col_rows, events);
+  }
+}
+
+static void debounce_run() {
+  l84_debounce_event_t events[L84_DEBOUNCE_MAX_EVENTS];
+  sink += l84_debounce_update(held_col_rows, events);
+}
+
+// Keymap: every key of the matrix, on both layers. A single lookup is too
+// short to time reliably.
+static void keymap_run() {
+  uint32_t sum = 0;
+  for (uint8_t key = 0; key < N_KEYS; ++key) {
+    sum += l84_keycode_get(L84_KEY_COL(key), L84_KEY_ROW(key), false);
+    sum += l84_keycode_get(L84_KEY_COL(key), L84_KEY_ROW(key), true);
+  }
+  sink += sum;
+}
+
+// Report build: the held keys, plus an SOCD pair to resolve
+static void report_setup() {
+  l84_keyorder_clear();
+  for (uint8_t i = 0; i < N_HELD_KEYS; ++i) {
+    l84_keyorder_press(L84_KEY_INDEX(held_keys[i][0], held_keys[i][1]),
+                       1000 * i);
+  }
+  l84_socd_set_default_pairs();
+  l84_socd_set_mode(L84_SOCD_LAST_INPUT);
+}
+
+static void report_run() {
+  l84_report_t report;
+  l84_report_build(&report, false);
+  sink += report.keycode[0];
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+const l84_bench_stage_t l84_bench_pipeline_stages[] = {
+    {"debounce", debounce_setup, NULL, debounce_run, 64},
+    {"keymap", NULL, NULL, keymap_run, 16},
+    {"report_build", report_setup, NULL, report_run, 64},
+};
+const uint8_t l84_bench_n_pipeline_stages =
+    sizeof(l84_bench_pipeline_stages) / sizeof(l84_bench_pipeline_stages[0]);
+
+uint32_t l84_bench_measure(const l84_bench_stage_t *stage,
+                           l84_bench_counter_fn now) {
+  if (stage->setup)
+    stage->setup();
+
+  // Warm up caches and branch predictors
+  time_batch(stage, now, stage->run);
+
+  uint32_t overhead = time_batch(stage, now, nop);
+  uint32_t ticks = time_batch(stage, now, stage->run);
+  ticks = ticks > overhead ? ticks - overhead : 0;
+
+  return (ticks + batch_calls(stage) / 2) / batch_calls(stage);
+}
+
+void l84_bench_run(const char *unit, const l84_bench_stage_t *stages,
+                   uint8_t n_stages, l84_bench_counter_fn now) {
+  printf("bench begin %s\n", unit);
+  for (uint8_t i = 0; i < n_stages; ++i) {
+    printf("bench %s %lu\n", stages[i].name,
+           (unsigned long)l84_bench_measure(&stages[i], now));
+  }
+  printf("bench end\n");
+}
@@ -0,0 +1,62 @@
+/*
+** file: lard84_bench.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Per-stage benchmarks of the input pipeline.
+** The runner and the pure-C stages (debounce, keymap, report build) build
+** both on a host and on the device. Stages that need the hardware (raw scan,
+** report submission) are defined by the device benchmark.
+**
+** Results are printed one line per stage, for tools/bench_compare.py:
+**   bench begin <unit>
+**   bench <stage> <ticks per call>
+**   bench end
+*/
+
+#ifndef _LARD84_BENCH_H
+#define _LARD84_BENCH_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Each stage is timed over L84_BENCH_REPS batches of calls; the fastest batch
+// is kept, to filter out interrupts and cache misses
+#define L84_BENCH_REPS 32
+
+// Batches are this many times longer than the stage's batch size. Host
+// timings need longer batches to rise above the timer and scheduling noise.
+#ifndef L84_BENCH_BATCH_SCALE
+#define L84_BENCH_BATCH_SCALE 1
+#endif
+
+// Free-running counter, wrapping around
+typedef uint32_t (*l84_bench_counter_fn)();
+
+typedef struct {
+  const char *name;
+  // Once before the stage, may be NULL
+  void (*setup)();
+  // Before each batch, outside of the timing, may be NULL
+  void (*prepare)();
+  // The call being measured
+  void (*run)();
+  // Calls per batch, times L84_BENCH_BATCH_SCALE
+  uint16_t batch;
+} l84_bench_stage_t;
+
+// Pure-C stages of the pipeline
+extern const l84_bench_stage_t l84_bench_pipeline_stages[];
+extern const uint8_t l84_bench_n_pipeline_stages;
+
+// Counter ticks per call of the stage, without the cost of the loop
+uint32_t l84_bench_measure(const l84_bench_stage_t *stage,
+                           l84_bench_counter_fn now);
+// Measure the stages and print the results
+void l84_bench_run(const char *unit, const l84_bench_stage_t *stages,
+                   uint8_t n_stages, l84_bench_counter_fn now);
+
+#endif /* _LARD84_BENCH_H */
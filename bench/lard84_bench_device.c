@@ -0,0 +1,113 @@
+/*
+** file: lard84_bench_device.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Benchmark firmware: the pipeline stages, plus the raw matrix scan and the
+** report submission, timed with the DWT cycle counter of core0. Results are
+** printed over stdio every few seconds, see tools/bench_compare.py --serial.
+**
+** Runs at the default clk_sys, the clock governor is not started.
+*/
+
+#include "lard84_bench.h"
+#include "lard84_board_scan.h"
+#include "lard84_cycles.h"
+#include "lard84_hid.h"
+#include "lard84_keymatrix.h"
+#include "lard84_led.h"
+#include "pico/stdlib.h"
+#include "tusb_config.h"
+#include <stdio.h>
+#include <string.h>
+#include <tusb.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+#define BENCH_INTERVAL_MS 5000
+#define MOUNT_TIMEOUT_MS 5000
+
+static volatile uint32_t sink = 0;
+
+static uint8_t col_rows[N_COLS];
+
+// Submission alternates between these keyboard reports, so every call has a
+// change to send. ErrorRollOver (0x01) in every slot is the "phantom state"
+// that hosts ignore, so nothing is typed while benchmarking.
+#define KEY_ERROR_ROLLOVER 0x01
+static l84_report_t submit_reports[2] = {
+    {.keycode = {KEY_ERROR_ROLLOVER, KEY_ERROR_ROLLOVER, KEY_ERROR_ROLLOVER,
+                 KEY_ERROR_ROLLOVER, KEY_ERROR_ROLLOVER, KEY_ERROR_ROLLOVER}},
+    {.keycode = {0}},
+};
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static void scan_run() {
+  l84_board_scan(col_rows);
+  sink += col_rows[0];
+}
+
+// Wait for the previous report to be picked up, the host polls every 1ms
+static void submit_prepare() {
+  absolute_time_t timeout = make_timeout_time_ms(100);
+  while (!tud_hid_ready() && !time_reached(timeout)) {
+    tud_task();
+  }
+}
+
+static void submit_run() {
+  static uint8_t i = 0;
+  i ^= 1;
+  l84_hid_update(&submit_reports[i], time_us_32());
+  sink += l84_hid_send_next(time_us_32());
+}
+
+static const l84_bench_stage_t scan_stage = {"scan", NULL, NULL, scan_run,
+                                             16};
+// One call per batch: the endpoint only takes one report at a time
+static const l84_bench_stage_t submit_stage = {"submit", NULL, submit_prepare,
+                                               submit_run, 1};
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+int main() {
+  stdio_init_all();
+  l84_cycles_init();
+  l84_keymatrix_setup();
+  l84_led_init();
+  tud_init(BOARD_TUD_RHPORT);
+
+  // The submission stage needs the host
+  absolute_time_t timeout = make_timeout_time_ms(MOUNT_TIMEOUT_MS);
+  while (!tud_mounted() && !time_reached(timeout)) {
+    tud_task();
+  }
+  if (!tud_mounted())
+    printf("Bench: USB not mounted, skipping the submit stage\n");
+
+  // Same order as the pipeline: scan, debounce, keymap, report build, submit
+  l84_bench_stage_t stages[8];
+  uint8_t n_stages = 0;
+  stages[n_stages++] = scan_stage;
+  memcpy(&stages[n_stages], l84_bench_pipeline_stages,
+         l84_bench_n_pipeline_stages * sizeof(l84_bench_stage_t));
+  n_stages += l84_bench_n_pipeline_stages;
+  if (tud_mounted())
+    stages[n_stages++] = submit_stage;
+
+  while (true) {
+    l84_bench_run("cycles", stages, n_stages, l84_cycles_now);
+
+    absolute_time_t next = make_timeout_time_ms(BENCH_INTERVAL_MS);
+    while (!time_reached(next)) {
+      tud_task();
+    }
+  }
+}
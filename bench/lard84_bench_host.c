@@ -0,0 +1,42 @@
+/*
+** file: lard84_bench_host.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Benchmark of the pure-C pipeline stages on the build machine.
+** Ticks are TSC ticks on x86, nanoseconds elsewhere.
+*/
+
+#include "lard84_bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_UNIT "tsc"
+static uint32_t counter_now() { return (uint32_t)__rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static uint32_t counter_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+int main() {
+  l84_bench_run(BENCH_UNIT, l84_bench_pipeline_stages,
+                l84_bench_n_pipeline_stages, counter_now);
+  return 0;
+}
@@ -0,0 +1,80 @@
+/*
+** file: lard84_boot.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Boot phase timestamps.
+*/
+
+#include "lard84_boot.h"
+
+#include "lard84_diag.h"
+#include "pico/time.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Each phase is written once, by one core
+static volatile uint32_t phase_us[L84_BOOT_N_PHASES] = {0};
+static volatile bool phase_reached[L84_BOOT_N_PHASES] = {0};
+
+static const char *phase_name[L84_BOOT_N_PHASES] = {
+    "main",         "stdio",    "core1 launch", "gpio setup",
+    "matrix ready", "usb init", "usb mounted",  "first report",
+};
+
+// Diagnostics topic: number of phases, 3 reserved bytes, then a 32 bit time
+// per phase, 0xffffffff if not reached yet
+#define TOPIC_HEADER_SIZE 4
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static uint16_t topic_size() {
+  return TOPIC_HEADER_SIZE + L84_BOOT_N_PHASES * sizeof(uint32_t);
+}
+
+static void topic_read(uint16_t offset, uint8_t *buf, uint16_t len) {
+  for (uint16_t i = 0; i < len; ++i) {
+    uint16_t pos = offset + i;
+    if (pos < TOPIC_HEADER_SIZE) {
+      buf[i] = pos == 0 ? L84_BOOT_N_PHASES : 0;
+      continue;
+    }
+    pos -= TOPIC_HEADER_SIZE;
+    uint8_t phase = pos / sizeof(uint32_t);
+    uint32_t t = phase_reached[phase] ? phase_us[phase] : 0xffffffffu;
+    buf[i] = (t >> (8 * (pos % sizeof(uint32_t)))) & 0xff;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_boot_mark(l84_boot_phase_t phase) {
+  if (phase_reached[phase])
+    return;
+  phase_us[phase] = time_us_32();
+  phase_reached[phase] = true;
+}
+
+bool l84_boot_reached(l84_boot_phase_t phase) { return phase_reached[phase]; }
+
+void l84_boot_init() {
+  l84_diag_register(L84_DIAG_TOPIC_BOOT, topic_size, topic_read);
+}
+
+void l84_boot_print_stats() {
+  printf("Boot:");
+  for (uint8_t phase = 0; phase < L84_BOOT_N_PHASES; ++phase) {
+    if (phase_reached[phase])
+      printf(" %s %luus,", phase_name[phase], (unsigned long)phase_us[phase]);
+    else
+      printf(" %s -,", phase_name[phase]);
+  }
+  printf("\n");
+}
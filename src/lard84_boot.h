@@ -0,0 +1,53 @@
+/*
+** file: lard84_boot.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Boot phase timestamps.
+** Times are from the timer, which starts counting when the runtime
+** initialisation releases it from reset, shortly after the bootrom hands
+** over. They can be read from the host as the L84_DIAG_TOPIC_BOOT
+** diagnostics topic.
+*/
+
+#ifndef _LARD84_BOOT_H
+#define _LARD84_BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+typedef enum {
+  // Core0 entered main: clocks and runtime are initialised
+  L84_BOOT_MAIN,
+  // stdio is up
+  L84_BOOT_STDIO,
+  // Core1 was launched
+  L84_BOOT_CORE1_LAUNCH,
+  // Core1 configured the matrix GPIOs
+  L84_BOOT_GPIO_SETUP,
+  // Core1 finished enough scans for held keys to be debounced
+  L84_BOOT_MATRIX_READY,
+  // tud_init returned, the device is visible on the bus
+  L84_BOOT_USB_INIT,
+  // The host configured the device
+  L84_BOOT_USB_MOUNTED,
+  // The first input report was handed to the USB stack
+  L84_BOOT_FIRST_REPORT,
+  L84_BOOT_N_PHASES,
+} l84_boot_phase_t;
+
+// Record the time a phase was reached. Only the first call per phase counts.
+// Can be called from either core.
+void l84_boot_mark(l84_boot_phase_t phase);
+// True once the phase was reached
+bool l84_boot_reached(l84_boot_phase_t phase);
+// Register the diagnostics topic
+void l84_boot_init();
+// Print the phase timestamps
+void l84_boot_print_stats();
+
+#endif /* _LARD84_BOOT_H */
@@ -0,0 +1,247 @@
+/*
+** file: lard84_clock.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** System clock and core voltage governor.
+*/
+
+#include "lard84_clock.h"
+
+#include "hardware/clocks.h"
+#include "hardware/uart.h"
+#include "hardware/vreg.h"
+#include "lard84_led.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+typedef struct {
+  // clk_sys is pll_sys divided by this
+  uint32_t sys_div;
+  enum vreg_voltage vsel;
+  uint32_t mv;
+} operating_point_t;
+
+// The burst point is the SDK default, so nothing runs faster than before.
+// Lower points only divide clk_sys: pll_sys keeps running, and switching
+// does not wait for it to relock.
+// The RP2350 is only specified at 1.10V, which all points use by default.
+// With L84_CLOCK_UNDERVOLT, the lower points also lower the core voltage,
+// outside of the datasheet: only for boards it was tested on.
+static const operating_point_t operating_points[L84_CLOCK_N_LEVELS] = {
+#if L84_CLOCK_UNDERVOLT
+    [L84_CLOCK_IDLE] = {3, VREG_VOLTAGE_0_95, 950},
+    [L84_CLOCK_TYPING] = {2, VREG_VOLTAGE_1_05, 1050},
+#else
+    [L84_CLOCK_IDLE] = {3, VREG_VOLTAGE_1_10, 1100},
+    [L84_CLOCK_TYPING] = {2, VREG_VOLTAGE_1_10, 1100},
+#endif
+    [L84_CLOCK_BURST] = {1, VREG_VOLTAGE_1_10, 1100},
+};
+
+static const char *level_name[L84_CLOCK_N_LEVELS] = {"idle", "typing",
+                                                     "burst"};
+static const char *policy_name[L84_CLOCK_N_POLICIES] = {
+    "performance", "balanced", "powersave"};
+
+// Time for the regulator output to settle after raising the voltage. The
+// clock goes up on a later l84_clock_task call, instead of waiting for it.
+#define VREG_SETTLE_US 1000
+
+// Power model used to compare the policies: static power plus dynamic power
+// proportional to f * V^2. These are uncalibrated placeholders, not
+// measurements, so only the ratios between policies are reported.
+#define POWER_STATIC 5000
+#define POWER_DYNAMIC_PER_MHZ 120
+
+static l84_clock_policy_t policy = L84_CLOCK_DEFAULT_POLICY;
+static l84_clock_level_t level = L84_CLOCK_BURST;
+static enum vreg_voltage vsel = VREG_VOLTAGE_DEFAULT;
+
+// Set while the regulator settles after raising the voltage
+static bool vreg_settling = false;
+static uint32_t vreg_settled_us = 0;
+
+static uint32_t last_activity_us = 0;
+static bool had_activity = false;
+static uint32_t burst_until_us = 0;
+static uint32_t burst_requested_us = 0;
+static bool burst_requested = false;
+
+// Time spent with each level of demand, independent of the policy, to
+// estimate what every policy would have cost
+static uint64_t demand_time_us[L84_CLOCK_N_LEVELS] = {0};
+static uint32_t last_task_us = 0;
+static uint32_t num_transitions = 0;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static bool time_reached(uint32_t now_us, uint32_t t_us) {
+  return (int32_t)(now_us - t_us) >= 0;
+}
+
+// What the keyboard is currently doing
+static l84_clock_level_t demand(uint32_t now_us) {
+  if (burst_requested && !time_reached(now_us, burst_until_us))
+    return L84_CLOCK_BURST;
+  burst_requested = false;
+
+  if (had_activity &&
+      !time_reached(now_us, last_activity_us + L84_CLOCK_TYPING_HOLD_US))
+    return L84_CLOCK_TYPING;
+  return L84_CLOCK_IDLE;
+}
+
+static l84_clock_level_t level_for(l84_clock_policy_t p, l84_clock_level_t d) {
+  switch (p) {
+  case L84_CLOCK_POLICY_PERFORMANCE:
+    return L84_CLOCK_BURST;
+  case L84_CLOCK_POLICY_POWERSAVE:
+    return d == L84_CLOCK_BURST ? L84_CLOCK_BURST : L84_CLOCK_IDLE;
+  case L84_CLOCK_POLICY_BALANCED:
+  default:
+    return d;
+  }
+}
+
+static uint32_t sys_khz(l84_clock_level_t l) {
+  return SYS_CLK_KHZ / operating_points[l].sys_div;
+}
+
+static uint64_t power(l84_clock_level_t l) {
+  const operating_point_t *op = &operating_points[l];
+  return POWER_STATIC + (uint64_t)POWER_DYNAMIC_PER_MHZ * (sys_khz(l) / 1000) *
+                            op->mv * op->mv / (1100 * 1100);
+}
+
+// Everything that derives from clk_sys is reconfigured here.
+// The matrix scan and the debounce are paced by the system timer, which
+// counts clk_ref ticks and does not depend on clk_sys.
+static void switch_clock(l84_clock_level_t new_level) {
+  const uint32_t sys_hz = sys_khz(new_level) * 1000;
+
+  // clk_peri follows clk_sys: let the UART finish sending at the old rate
+  uart_tx_wait_blocking(uart_default);
+
+  clock_configure_int_divider(clk_sys,
+                              CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                              CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS,
+                              SYS_CLK_HZ, operating_points[new_level].sys_div);
+  clock_configure_undivided(clk_peri, 0,
+                            CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, sys_hz);
+
+  uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+  l84_led_on_clock_change();
+
+  level = new_level;
+  num_transitions++;
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_clock_set_policy(l84_clock_policy_t new_policy) {
+  policy = new_policy;
+}
+
+l84_clock_policy_t l84_clock_get_policy() { return policy; }
+
+l84_clock_level_t l84_clock_get_level() { return level; }
+
+void l84_clock_note_activity(uint32_t now_us) {
+  last_activity_us = now_us;
+  had_activity = true;
+}
+
+void l84_clock_request_burst(uint32_t now_us, uint32_t duration_us) {
+  uint32_t until_us = now_us + duration_us;
+  if (!burst_requested || time_reached(until_us, burst_until_us))
+    burst_until_us = until_us;
+  burst_requested = true;
+  burst_requested_us = now_us;
+}
+
+void l84_clock_task(uint32_t now_us) {
+  l84_clock_level_t d = demand(now_us);
+
+  if (last_task_us)
+    demand_time_us[d] += now_us - last_task_us;
+  last_task_us = now_us;
+
+  l84_clock_level_t target = level_for(policy, d);
+  enum vreg_voltage target_vsel = operating_points[target].vsel;
+
+  // Voltage goes down after the clock, and up before it
+  if (target < level)
+    switch_clock(target);
+
+  if (target_vsel < vsel) {
+    vreg_set_voltage(target_vsel);
+    vsel = target_vsel;
+    vreg_settling = false;
+  } else if (target_vsel > vsel) {
+    // The change that woke this core up is handled at the current clock,
+    // rather than waiting for the regulator
+    vreg_set_voltage(target_vsel);
+    vsel = target_vsel;
+    vreg_settling = true;
+    vreg_settled_us = now_us + VREG_SETTLE_US;
+  }
+
+  if (vreg_settling && time_reached(now_us, vreg_settled_us))
+    vreg_settling = false;
+
+  if (target > level && !vreg_settling)
+    switch_clock(target);
+}
+
+bool l84_clock_next_wakeup(uint32_t *wakeup_us) {
+  if (vreg_settling) {
+    *wakeup_us = vreg_settled_us;
+    return true;
+  }
+  // A burst was requested since the last task call: switch right away
+  if (burst_requested && level != L84_CLOCK_BURST) {
+    *wakeup_us = burst_requested_us;
+    return true;
+  }
+  return false;
+}
+
+void l84_clock_print_stats() {
+  uint64_t total_us = 0;
+  for (uint l = 0; l < L84_CLOCK_N_LEVELS; ++l) {
+    total_us += demand_time_us[l];
+  }
+  if (!total_us)
+    return;
+
+  printf("Clock: %s at %lukHz, %lu transitions, activity", policy_name[policy],
+         (unsigned long)sys_khz(level), (unsigned long)num_transitions);
+  for (uint l = 0; l < L84_CLOCK_N_LEVELS; ++l) {
+    printf(" %s %llu%%", level_name[l], (100 * demand_time_us[l]) / total_us);
+  }
+  printf("\n");
+
+  // Energy each policy would use over the activity seen so far, relative to
+  // the performance policy
+  uint64_t energy[L84_CLOCK_N_POLICIES] = {0};
+  for (uint p = 0; p < L84_CLOCK_N_POLICIES; ++p) {
+    for (uint l = 0; l < L84_CLOCK_N_LEVELS; ++l) {
+      energy[p] += power(level_for(p, l)) * demand_time_us[l];
+    }
+  }
+  printf("Clock: estimated energy (uncalibrated model):");
+  for (uint p = 0; p < L84_CLOCK_N_POLICIES; ++p) {
+    printf(" %s %llu%%", policy_name[p],
+           (100 * energy[p]) / energy[L84_CLOCK_POLICY_PERFORMANCE]);
+  }
+  printf("\n");
+}
@@ -0,0 +1,73 @@
+/*
+** file: lard84_clock.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** System clock and core voltage governor.
+** The keyboard needs very little of the RP2350 most of the time: clk_sys
+** is lowered while idle or typing, and raised for bursts of work such as
+** flash writes. The core voltage stays at the specified 1.10V, unless
+** L84_CLOCK_UNDERVOLT is set.
+*/
+
+#ifndef _LARD84_CLOCK_H
+#define _LARD84_CLOCK_H
+
+#include "pico/types.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Operating points, from slowest to fastest
+typedef enum {
+  L84_CLOCK_IDLE,
+  L84_CLOCK_TYPING,
+  L84_CLOCK_BURST,
+  L84_CLOCK_N_LEVELS,
+} l84_clock_level_t;
+
+typedef enum {
+  // Always at the burst operating point, like the SDK default
+  L84_CLOCK_POLICY_PERFORMANCE,
+  // Idle, typing or burst operating point depending on activity
+  L84_CLOCK_POLICY_BALANCED,
+  // Idle operating point unless a burst is requested
+  L84_CLOCK_POLICY_POWERSAVE,
+  L84_CLOCK_N_POLICIES,
+} l84_clock_policy_t;
+
+// Lower the core voltage along with clk_sys, below the 1.10V the RP2350 is
+// specified at. Off by default.
+#ifndef L84_CLOCK_UNDERVOLT
+#define L84_CLOCK_UNDERVOLT 0
+#endif
+
+#ifndef L84_CLOCK_DEFAULT_POLICY
+#define L84_CLOCK_DEFAULT_POLICY L84_CLOCK_POLICY_BALANCED
+#endif
+
+// Time without key activity before dropping from typing to idle
+#define L84_CLOCK_TYPING_HOLD_US 2000000
+
+void l84_clock_set_policy(l84_clock_policy_t policy);
+l84_clock_policy_t l84_clock_get_policy();
+l84_clock_level_t l84_clock_get_level();
+
+// Keys changed: keep the typing operating point for a while
+void l84_clock_note_activity(uint32_t now_us);
+// Run at the burst operating point for at least duration_us.
+// Takes effect at the next l84_clock_task call.
+void l84_clock_request_burst(uint32_t now_us, uint32_t duration_us);
+// Switch operating point if needed. Only call from core0.
+// Never blocks on the regulator: when the voltage has to go up first, the
+// clock follows on a call after it settled.
+void l84_clock_task(uint32_t now_us);
+// If the operating point is about to change (a burst request, the regulator
+// settling), set wakeup_us to when l84_clock_task should run and return true
+bool l84_clock_next_wakeup(uint32_t *wakeup_us);
+// Print the time spent at each activity level, and the energy each policy
+// would have used over that activity, relative to the performance policy
+void l84_clock_print_stats();
+
+#endif /* _LARD84_CLOCK_H */
@@ -0,0 +1,262 @@
+/*
+** file: lard84_combo.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Combos (chords): two or more keys pressed within a short window emit a
+** different keycode.
+*/
+
+#include "lard84_combo.h"
+
+#include "lard84_keyorder.h"
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Compiled combo table
+static l84_keymask_t combo_mask[L84_COMBO_MAX];
+static uint32_t combo_keycode[L84_COMBO_MAX];
+static uint8_t num_combos = 0;
+
+// Union of all combo masks: keys that may be held back
+static l84_keymask_t combo_keys = {0};
+
+// Presses held back while a combo may still match, oldest first
+static l84_keyorder_entry_t pending[L84_COMBO_MAX_KEYS];
+static uint8_t num_pending = 0;
+static l84_keymask_t pending_mask = {0};
+
+// Keys held down as part of an active combo. Their releases end the
+// combo instead of being forwarded.
+static l84_keymask_t consumed = {0};
+// One bit per combo that is currently pressed
+static uint32_t active_combos = 0;
+
+// Releases of held-back keys, postponed by L84_COMBO_TAP_HOLD_US
+static struct {
+  uint8_t key;
+  uint32_t time_us;
+} deferred[L84_COMBO_MAX_KEYS];
+static uint8_t num_deferred = 0;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+// Index of the combo made of exactly the pending keys, or -1
+static int find_exact_match() {
+  for (uint8_t c = 0; c < num_combos; ++c) {
+    if (l84_keymask_equal(&combo_mask[c], &pending_mask))
+      return c;
+  }
+  return -1;
+}
+
+// True if a larger combo could still complete with more presses
+static bool can_grow() {
+  for (uint8_t c = 0; c < num_combos; ++c) {
+    if (l84_keymask_contains(&combo_mask[c], &pending_mask) &&
+        !l84_keymask_equal(&combo_mask[c], &pending_mask))
+      return true;
+  }
+  return false;
+}
+
+static void clear_pending() {
+  num_pending = 0;
+  memset(&pending_mask, 0, sizeof(pending_mask));
+}
+
+static void fire(uint8_t c) {
+  l84_keyorder_press(L84_KEY_VIRTUAL(c), pending[0].time_us);
+  for (int i = 0; i < L84_KEYMASK_WORDS; ++i)
+    consumed.w[i] |= pending_mask.w[i];
+  active_combos |= 1u << c;
+  clear_pending();
+}
+
+// Forward held-back presses as regular keys, with their original timestamps
+static void flush() {
+  for (uint8_t i = 0; i < num_pending; ++i) {
+    l84_keyorder_press(pending[i].key, pending[i].time_us);
+  }
+  clear_pending();
+}
+
+static void resolve() {
+  int c = find_exact_match();
+  if (c >= 0)
+    fire((uint8_t)c);
+  else
+    flush();
+}
+
+static void release(uint8_t key) {
+  if (!l84_keymask_test(&consumed, key)) {
+    l84_keyorder_release(key);
+    return;
+  }
+
+  // Releasing any key of an active combo releases the combo. The other keys
+  // of the combo stay consumed until they are released too.
+  l84_keymask_clear(&consumed, key);
+  for (uint8_t c = 0; c < num_combos; ++c) {
+    if ((active_combos & (1u << c)) && l84_keymask_test(&combo_mask[c], key)) {
+      l84_keyorder_release(L84_KEY_VIRTUAL(c));
+      active_combos &= ~(1u << c);
+    }
+  }
+}
+
+// Time of a pending deferred release that also releases an active combo of
+// key, or false if there is none
+static bool find_deferred_combo_release(uint8_t key, uint32_t *time_us) {
+  for (uint8_t i = 0; i < num_deferred; ++i) {
+    for (uint8_t c = 0; c < num_combos; ++c) {
+      if ((active_combos & (1u << c)) &&
+          l84_keymask_test(&combo_mask[c], key) &&
+          l84_keymask_test(&combo_mask[c], deferred[i].key)) {
+        *time_us = deferred[i].time_us;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static void run_deferred_release(uint8_t i) {
+  uint8_t key = deferred[i].key;
+  memmove(&deferred[i], &deferred[i + 1],
+          (num_deferred - i - 1) * sizeof(deferred[0]));
+  num_deferred--;
+  release(key);
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+uint8_t l84_combo_load(const l84_combo_def_t *defs, uint8_t n_defs) {
+  num_combos = 0;
+  memset(&combo_keys, 0, sizeof(combo_keys));
+  clear_pending();
+  memset(&consumed, 0, sizeof(consumed));
+  active_combos = 0;
+  num_deferred = 0;
+
+  for (uint8_t d = 0; d < n_defs && num_combos < L84_COMBO_MAX; ++d) {
+    const l84_combo_def_t *def = &defs[d];
+    if (def->n_keys < 2 || def->n_keys > L84_COMBO_MAX_KEYS)
+      continue;
+
+    l84_keymask_t mask = {0};
+    bool valid = true;
+    for (uint8_t k = 0; k < def->n_keys; ++k) {
+      if (def->keys[k] >= N_KEYS) {
+        valid = false;
+        break;
+      }
+      l84_keymask_set(&mask, def->keys[k]);
+    }
+    if (!valid)
+      continue;
+
+    combo_mask[num_combos] = mask;
+    combo_keycode[num_combos] = def->keycode;
+    for (int i = 0; i < L84_KEYMASK_WORDS; ++i)
+      combo_keys.w[i] |= mask.w[i];
+    num_combos++;
+  }
+
+  return num_combos;
+}
+
+uint32_t l84_combo_keycode(uint8_t combo) {
+  return combo < num_combos ? combo_keycode[combo] : 0;
+}
+
+void l84_combo_on_press(uint8_t key, uint32_t now_us) {
+  // A quick re-press of a key whose release is still deferred
+  for (uint8_t i = 0; i < num_deferred; ++i) {
+    if (deferred[i].key == key) {
+      run_deferred_release(i);
+      break;
+    }
+  }
+
+  if (key >= N_KEYS || !l84_keymask_test(&combo_keys, key)) {
+    // Not part of any combo: no added latency. Anything held back was
+    // pressed before this key, so it is resolved first to keep the order.
+    if (num_pending)
+      resolve();
+    l84_keyorder_press(key, now_us);
+    return;
+  }
+
+  pending[num_pending].key = key;
+  pending[num_pending].time_us = now_us;
+  num_pending++;
+  l84_keymask_set(&pending_mask, key);
+
+  int exact = find_exact_match();
+  bool grow = can_grow();
+
+  if (exact >= 0 && !grow) {
+    fire((uint8_t)exact);
+  } else if (exact < 0 && !grow) {
+    // The new key cannot complete any combo together with the held-back
+    // keys: settle those, and start over with the new key alone.
+    num_pending--;
+    l84_keymask_clear(&pending_mask, key);
+    resolve();
+
+    pending[0].key = key;
+    pending[0].time_us = now_us;
+    num_pending = 1;
+    l84_keymask_set(&pending_mask, key);
+  }
+  // Otherwise, a combo may still match: keep waiting
+}
+
+void l84_combo_on_release(uint8_t key, uint32_t now_us) {
+  uint32_t release_us = now_us + L84_COMBO_TAP_HOLD_US;
+  bool defer = false;
+  if (key < N_KEYS && l84_keymask_test(&pending_mask, key)) {
+    // Released before the window closed: settle now, and keep the result
+    // pressed for a little while so that the host sees the tap.
+    resolve();
+    defer = true;
+  } else if (key < N_KEYS && l84_keymask_test(&consumed, key)) {
+    // The combo of this key may have fired on the release of another of its
+    // keys, e.g. all released in the same scan: keep it until then too.
+    defer = find_deferred_combo_release(key, &release_us);
+  }
+
+  if (defer && num_deferred < L84_COMBO_MAX_KEYS) {
+    deferred[num_deferred].key = key;
+    deferred[num_deferred].time_us = release_us;
+    num_deferred++;
+    return;
+  }
+
+  release(key);
+}
+
+void l84_combo_task(uint32_t now_us) {
+  if (num_pending &&
+      (uint32_t)(now_us - pending[0].time_us) >= L84_COMBO_TERM_US) {
+    resolve();
+  }
+
+  for (uint8_t i = 0; i < num_deferred;) {
+    if ((int32_t)(now_us - deferred[i].time_us) >= 0)
+      run_deferred_release(i);
+    else
+      ++i;
+  }
+}
+
+bool l84_combo_is_waiting() { return num_pending || num_deferred; }
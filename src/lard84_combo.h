@@ -0,0 +1,66 @@
+/*
+** file: lard84_combo.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Combos (chords): two or more keys pressed within a short window emit a
+** different keycode.
+**
+** The engine sits between the debounced key edges of the keymatrix and the
+** press-order list. Presses of keys that belong to a combo are held back
+** until either a combo is complete, no combo can match anymore, or the
+** window expires. Keys that are not part of any combo are forwarded
+** immediately.
+*/
+
+#ifndef _LARD84_COMBO_H
+#define _LARD84_COMBO_H
+
+#include "lard84_keymask.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Maximum number of combos. Each active combo is a virtual key.
+#define L84_COMBO_MAX L84_N_VIRTUAL_KEYS
+// Maximum number of keys in a single combo
+#define L84_COMBO_MAX_KEYS 4
+
+// Time window in which all keys of a combo must be pressed
+#ifndef L84_COMBO_TERM_US
+#define L84_COMBO_TERM_US 40000
+#endif
+
+// Minimum time a held-back key stays pressed once it is forwarded.
+// Without it, a key tapped within the combo window would be pressed and
+// released in the same scan, and never make it into a report.
+#ifndef L84_COMBO_TAP_HOLD_US
+#define L84_COMBO_TAP_HOLD_US 8000
+#endif
+
+// Combo as written in a keymap
+typedef struct {
+  // Flat key indices, see L84_KEY_INDEX
+  uint8_t keys[L84_COMBO_MAX_KEYS];
+  uint8_t n_keys;
+  // Keycode emitted while the combo is held
+  uint32_t keycode;
+} l84_combo_def_t;
+
+// Replace the combo table. Definitions are compiled into bitmasks.
+// Returns the number of combos that were accepted.
+uint8_t l84_combo_load(const l84_combo_def_t *defs, uint8_t n_defs);
+// Keycode of the combo behind virtual key L84_KEY_VIRTUAL(combo)
+uint32_t l84_combo_keycode(uint8_t combo);
+
+// Debounced edges from the keymatrix
+void l84_combo_on_press(uint8_t key, uint32_t now_us);
+void l84_combo_on_release(uint8_t key, uint32_t now_us);
+// Call once per scan, after the edges, to expire the combo window
+void l84_combo_task(uint32_t now_us);
+// True while presses are held back or releases deferred, i.e. while
+// l84_combo_task may still change the key order
+bool l84_combo_is_waiting();
+
+#endif /* _LARD84_COMBO_H */
@@ -0,0 +1,30 @@
+/*
+** file: lard84_cycles.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Cycle counting with the Cortex-M33 DWT cycle counter.
+** Each core has its own counter: l84_cycles_init must be called on every
+** core that measures.
+*/
+
+#ifndef _LARD84_CYCLES_H
+#define _LARD84_CYCLES_H
+
+#include "hardware/structs/m33.h"
+#include "pico/types.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+static inline void l84_cycles_init() {
+  m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+  m33_hw->dwt_cyccnt = 0;
+  m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+}
+
+// Free-running, wraps around: only use differences
+static inline uint32_t l84_cycles_now() { return m33_hw->dwt_cyccnt; }
+
+#endif /* _LARD84_CYCLES_H */
@@ -0,0 +1,76 @@
+/*
+** file: lard84_debounce.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Debouncing of the raw matrix scan into press/release edges.
+*/
+
+#include "lard84_debounce.h"
+
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// The following arrays are slightly larger than they need to be: we only
+// have 84 physical keys. This is just more convenient for looping over
+// rows and columns.
+
+// Keys that are registered as pressed, after debouncing
+static bool pressed[N_COLS][N_ROWS] = {0};
+
+// Number of consecutive scans that a given key reads closed.
+// When the number exceeds L84_DEBOUNCE_THRESHOLD_SCANS, the key
+// registers as pressed.
+static uint16_t num_pressed_scans[N_COLS][N_ROWS] = {0};
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+uint8_t l84_debounce_update(const uint8_t col_rows[N_COLS],
+                            l84_debounce_event_t *events) {
+  uint8_t n = 0;
+
+  for (uint8_t col = 0; col < N_COLS; ++col) {
+    for (uint8_t row = 0; row < N_ROWS; ++row) {
+      bool state = (col_rows[col] >> row) & 1;
+
+      if (state) {
+        // Saturate, a key can be held for longer than the counter lasts
+        if (num_pressed_scans[col][row] <= L84_DEBOUNCE_THRESHOLD_SCANS)
+          num_pressed_scans[col][row] += 1;
+
+        if (num_pressed_scans[col][row] > L84_DEBOUNCE_THRESHOLD_SCANS &&
+            !pressed[col][row]) {
+          pressed[col][row] = true;
+          events[n++] = (l84_debounce_event_t){L84_KEY_INDEX(col, row),
+                                               L84_DEBOUNCE_PRESS};
+        }
+      } else {
+        if (pressed[col][row]) {
+          pressed[col][row] = false;
+          events[n++] = (l84_debounce_event_t){L84_KEY_INDEX(col, row),
+                                               L84_DEBOUNCE_RELEASE};
+        } else if (num_pressed_scans[col][row] > 0) {
+          events[n++] = (l84_debounce_event_t){L84_KEY_INDEX(col, row),
+                                               L84_DEBOUNCE_CHATTER};
+        }
+        num_pressed_scans[col][row] = 0;
+      }
+    }
+  }
+
+  return n;
+}
+
+bool l84_debounce_is_pressed(uint8_t col, uint8_t row) {
+  return pressed[col][row];
+}
+
+void l84_debounce_reset() {
+  memset(pressed, 0, sizeof(pressed));
+  memset(num_pressed_scans, 0, sizeof(num_pressed_scans));
+}
@@ -0,0 +1,50 @@
+/*
+** file: lard84_debounce.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Debouncing of the raw matrix scan into press/release edges.
+** Only depends on the C standard library and the board header, like
+** lard84_keymask.h, so that it can be benchmarked on a host.
+*/
+
+#ifndef _LARD84_DEBOUNCE_H
+#define _LARD84_DEBOUNCE_H
+
+#include "lard84_keymask.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Number of consecutive scans a switch must read closed before it registers
+// as pressed is one more than this
+#define L84_DEBOUNCE_THRESHOLD_SCANS 5
+
+typedef enum {
+  // Debounced press
+  L84_DEBOUNCE_PRESS,
+  // Release of a debounced press
+  L84_DEBOUNCE_RELEASE,
+  // Contact that went away before being debounced: switch chatter
+  L84_DEBOUNCE_CHATTER,
+} l84_debounce_edge_t;
+
+typedef struct {
+  uint8_t key;
+  uint8_t edge;
+} l84_debounce_event_t;
+
+// A single scan produces at most one event per key
+#define L84_DEBOUNCE_MAX_EVENTS N_KEYS
+
+// Feed a scan, col_rows[col] having bit row set when the switch at (col, row)
+// reads closed. Events are written in scan order, returns their number.
+uint8_t l84_debounce_update(const uint8_t col_rows[N_COLS],
+                            l84_debounce_event_t *events);
+// Returns true if the switch at (col, row) is pressed, after debouncing
+bool l84_debounce_is_pressed(uint8_t col, uint8_t row);
+// Forget all state, e.g. between benchmark runs
+void l84_debounce_reset();
+
+#endif /* _LARD84_DEBOUNCE_H */
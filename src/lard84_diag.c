@@ -0,0 +1,76 @@
+/*
+** file: lard84_diag.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Diagnostics readable from the host through a vendor-defined HID feature
+** report.
+*/
+
+#include "lard84_diag.h"
+
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+static struct {
+  l84_diag_size_fn size;
+  l84_diag_read_fn read;
+} topics[L84_DIAG_N_TOPICS] = {0};
+
+// Selected by the last SET_REPORT
+static uint8_t selected_topic = 0;
+static uint16_t selected_page = 0;
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_diag_register(uint8_t topic, l84_diag_size_fn size_fn,
+                       l84_diag_read_fn read_fn) {
+  if (topic >= L84_DIAG_N_TOPICS)
+    return;
+  topics[topic].size = size_fn;
+  topics[topic].read = read_fn;
+}
+
+void l84_diag_select(const uint8_t *buf, uint16_t len) {
+  if (len < 1)
+    return;
+  selected_topic = buf[0];
+  selected_page = len >= 3 ? (uint16_t)(buf[1] | (buf[2] << 8)) : 0;
+}
+
+uint16_t l84_diag_get_report(uint8_t *buf, uint16_t reqlen) {
+  if (reqlen < L84_DIAG_REPORT_SIZE)
+    return 0;
+
+  memset(buf, 0, L84_DIAG_REPORT_SIZE);
+
+  uint16_t size = 0;
+  uint8_t n = 0;
+  if (selected_topic < L84_DIAG_N_TOPICS && topics[selected_topic].size) {
+    size = topics[selected_topic].size();
+    uint32_t offset = (uint32_t)selected_page * L84_DIAG_PAGE_SIZE;
+    if (offset < size) {
+      n = size - offset < L84_DIAG_PAGE_SIZE ? size - offset
+                                             : L84_DIAG_PAGE_SIZE;
+      topics[selected_topic].read(offset, &buf[L84_DIAG_HEADER_SIZE], n);
+    }
+  }
+
+  buf[0] = selected_topic;
+  buf[2] = selected_page & 0xff;
+  buf[3] = selected_page >> 8;
+  buf[4] = size & 0xff;
+  buf[5] = size >> 8;
+  buf[6] = n;
+
+  // Reading a page moves on to the next one, so a host can read a whole
+  // topic with a single SET_REPORT followed by GET_REPORTs
+  selected_page++;
+
+  return L84_DIAG_REPORT_SIZE;
+}
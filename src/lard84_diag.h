@@ -0,0 +1,53 @@
+/*
+** file: lard84_diag.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Diagnostics readable from the host through a vendor-defined HID feature
+** report, see tools/lard84_diag.py.
+**
+** The host selects a topic and a page with SET_REPORT(feature), then reads
+** the page with GET_REPORT(feature). Each topic is a flat byte buffer,
+** produced on demand by the module that owns it.
+**
+** GET_REPORT layout (after the report ID):
+**   0: topic, 1: reserved, 2-3: page (LE), 4-5: topic size in bytes (LE),
+**   6: number of data bytes in this page, 7: reserved,
+**   8-: data
+*/
+
+#ifndef _LARD84_DIAG_H
+#define _LARD84_DIAG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Size of the feature report, without the report ID
+#define L84_DIAG_REPORT_SIZE 63
+#define L84_DIAG_HEADER_SIZE 8
+#define L84_DIAG_PAGE_SIZE (L84_DIAG_REPORT_SIZE - L84_DIAG_HEADER_SIZE)
+
+enum {
+  L84_DIAG_TOPIC_KEYSTATS = 1,
+  L84_DIAG_TOPIC_BOOT,
+  L84_DIAG_TOPIC_STACK,
+  L84_DIAG_N_TOPICS,
+};
+
+// Total size of the topic, in bytes
+typedef uint16_t (*l84_diag_size_fn)();
+// Copy len bytes of the topic, starting at offset, into buf
+typedef void (*l84_diag_read_fn)(uint16_t offset, uint8_t *buf, uint16_t len);
+
+void l84_diag_register(uint8_t topic, l84_diag_size_fn size_fn,
+                       l84_diag_read_fn read_fn);
+
+// Called from the HID report callbacks
+void l84_diag_select(const uint8_t *buf, uint16_t len);
+uint16_t l84_diag_get_report(uint8_t *buf, uint16_t reqlen);
+
+#endif /* _LARD84_DIAG_H */
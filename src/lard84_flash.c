@@ -0,0 +1,68 @@
+/*
+** file: lard84_flash.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Flash erase/program that are safe to call while core1 is running.
+*/
+
+#include "lard84_flash.h"
+
+#include "hardware/regs/addressmap.h"
+#include "pico/flash.h"
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Maximum time to wait for core1 to be paused or resumed
+#define FLASH_LOCKOUT_TIMEOUT_MS 100
+
+typedef struct {
+  uint32_t offset;
+  const void *data;
+  uint32_t len;
+} flash_op_t;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+// Run with interrupts disabled and core1 paused, see flash_safe_execute
+static void do_erase(void *param) {
+  const flash_op_t *op = param;
+  flash_range_erase(op->offset, op->len);
+}
+
+static void do_program(void *param) {
+  const flash_op_t *op = param;
+  flash_range_program(op->offset, op->data, op->len);
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_flash_core1_init() { flash_safe_execute_core_init(); }
+
+bool l84_flash_erase(uint32_t offset, uint32_t len) {
+  flash_op_t op = {offset, NULL, len};
+  return l84_flash_safe_call(do_erase, &op);
+}
+
+bool l84_flash_program(uint32_t offset, const void *data, uint32_t len) {
+  flash_op_t op = {offset, data, len};
+  return l84_flash_safe_call(do_program, &op);
+}
+
+bool l84_flash_safe_call(void (*fn)(void *), void *param) {
+  return flash_safe_execute(fn, param, FLASH_LOCKOUT_TIMEOUT_MS) == PICO_OK;
+}
+
+const void *l84_flash_read_ptr(uint32_t offset) {
+#ifdef XIP_NOCACHE_NOALLOC_NOTRANSLATE_BASE
+  return (const void *)(XIP_NOCACHE_NOALLOC_NOTRANSLATE_BASE + offset);
+#else
+  return (const void *)(XIP_NOCACHE_NOALLOC_BASE + offset);
+#endif
+}
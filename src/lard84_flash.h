@@ -0,0 +1,37 @@
+/*
+** file: lard84_flash.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Flash erase/program that are safe to call while core1 is running.
+** The other core is paused (multicore lockout) for the duration of each
+** operation, so callers should keep operations short and do them when the
+** keyboard is idle.
+*/
+
+#ifndef _LARD84_FLASH_H
+#define _LARD84_FLASH_H
+
+#include "hardware/flash.h"
+#include "pico/types.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Must be called on core1 before core0 writes to flash
+void l84_flash_core1_init();
+
+// Offsets are from the start of flash. Erases are in FLASH_SECTOR_SIZE
+// units, programs in FLASH_PAGE_SIZE units. Return false on failure.
+bool l84_flash_erase(uint32_t offset, uint32_t len);
+bool l84_flash_program(uint32_t offset, const void *data, uint32_t len);
+
+// Run fn(param) under the same conditions, for other code that writes to
+// flash (e.g. bootrom calls)
+bool l84_flash_safe_call(void (*fn)(void *), void *param);
+
+// Uncached, untranslated view of flash at offset, for reading back
+const void *l84_flash_read_ptr(uint32_t offset);
+
+#endif /* _LARD84_FLASH_H */
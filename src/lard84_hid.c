@@ -0,0 +1,230 @@
+/*
+** file: lard84_hid.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Scheduling of the HID input reports on the single interrupt IN endpoint.
+*/
+
+#include "lard84_hid.h"
+
+#include "class/hid/hid.h"
+#include "class/hid/hid_device.h"
+#include "lard84_keycodes.h"
+#include <stdio.h>
+#include <string.h>
+#include <tusb.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Latest state from the report builder, and what the host last received
+static l84_report_t current = {0};
+static l84_report_t sent = {0};
+
+static bool dirty[L84_REPORT_ID_COUNT] = {0};
+
+// Next time the pointer/wheel may move while their keys are held
+static uint32_t next_move_us = 0;
+static uint32_t next_wheel_us = 0;
+static bool move_due = false;
+static bool wheel_due = false;
+
+// Reports and bytes sent per report ID, index 0 counts boot protocol
+// keyboard reports
+static uint32_t report_count[L84_REPORT_ID_COUNT] = {0};
+static uint32_t byte_count[L84_REPORT_ID_COUNT] = {0};
+
+static const char *report_name[L84_REPORT_ID_COUNT] = {
+    "boot kbd", "keyboard", "consumer", "system", "mouse",
+};
+
+#define MOUSE_MOVE_BITS                                                        \
+  (L84_MOUSE_MOTION_UP | L84_MOUSE_MOTION_DOWN | L84_MOUSE_MOTION_LEFT |       \
+   L84_MOUSE_MOTION_RIGHT)
+#define MOUSE_WHEEL_BITS                                                       \
+  (L84_MOUSE_MOTION_WHEEL_UP | L84_MOUSE_MOTION_WHEEL_DOWN)
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static bool time_reached(uint32_t now_us, uint32_t t_us) {
+  return (int32_t)(now_us - t_us) >= 0;
+}
+
+static void count_report(uint8_t id, uint32_t len) {
+  report_count[id]++;
+  byte_count[id] += len;
+}
+
+static int8_t axis(uint8_t motion, uint8_t neg, uint8_t pos, int8_t step) {
+  return (int8_t)(((motion & pos) ? step : 0) - ((motion & neg) ? step : 0));
+}
+
+static bool send_report(uint8_t id, uint32_t now_us) {
+  bool ok = false;
+
+  switch (id) {
+  case L84_REPORT_ID_KEYBOARD:
+    ok = tud_hid_keyboard_report(id, 0, current.keycode);
+    if (ok) {
+      memcpy(sent.keycode, current.keycode, sizeof(sent.keycode));
+      count_report(id, 1 + 8);
+    }
+    break;
+  case L84_REPORT_ID_CONSUMER:
+    ok = tud_hid_report(id, &current.consumer, sizeof(current.consumer));
+    if (ok) {
+      sent.consumer = current.consumer;
+      count_report(id, 1 + sizeof(current.consumer));
+    }
+    break;
+  case L84_REPORT_ID_SYSTEM: {
+    // The system control report is an index from 1 (power down) to 3
+    // (wake up), 0 meaning no usage
+    uint8_t value = 0;
+    if (current.system)
+      value = current.system - HID_USAGE_DESKTOP_SYSTEM_POWER_DOWN + 1;
+    ok = tud_hid_report(id, &value, sizeof(value));
+    if (ok) {
+      sent.system = current.system;
+      count_report(id, 1 + sizeof(value));
+    }
+    break;
+  }
+  case L84_REPORT_ID_MOUSE: {
+    const uint8_t motion = current.mouse_motion;
+    int8_t x = 0, y = 0, wheel = 0;
+    if (move_due) {
+      x = axis(motion, L84_MOUSE_MOTION_LEFT, L84_MOUSE_MOTION_RIGHT,
+               L84_MOUSE_STEP);
+      y = axis(motion, L84_MOUSE_MOTION_UP, L84_MOUSE_MOTION_DOWN,
+               L84_MOUSE_STEP);
+    }
+    if (wheel_due) {
+      wheel = axis(motion, L84_MOUSE_MOTION_WHEEL_DOWN,
+                   L84_MOUSE_MOTION_WHEEL_UP, 1);
+    }
+    ok = tud_hid_mouse_report(id, current.mouse_buttons, x, y, wheel, 0);
+    if (ok) {
+      sent.mouse_buttons = current.mouse_buttons;
+      if (move_due)
+        next_move_us = now_us + L84_MOUSE_MOVE_INTERVAL_US;
+      if (wheel_due)
+        next_wheel_us = now_us + L84_MOUSE_WHEEL_INTERVAL_US;
+      move_due = wheel_due = false;
+      count_report(id, 1 + 5);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+
+  if (ok)
+    dirty[id] = false;
+  return ok;
+}
+
+static void update_dirty(uint32_t now_us) {
+  if (memcmp(current.keycode, sent.keycode, sizeof(sent.keycode)))
+    dirty[L84_REPORT_ID_KEYBOARD] = true;
+  if (current.consumer != sent.consumer)
+    dirty[L84_REPORT_ID_CONSUMER] = true;
+  if (current.system != sent.system)
+    dirty[L84_REPORT_ID_SYSTEM] = true;
+
+  // Mouse reports are relative: held motion keys need a report every
+  // interval, not only when they change
+  if ((current.mouse_motion & MOUSE_MOVE_BITS) &&
+      time_reached(now_us, next_move_us))
+    move_due = true;
+  if ((current.mouse_motion & MOUSE_WHEEL_BITS) &&
+      time_reached(now_us, next_wheel_us))
+    wheel_due = true;
+  if (current.mouse_buttons != sent.mouse_buttons || move_due || wheel_due)
+    dirty[L84_REPORT_ID_MOUSE] = true;
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_hid_update(const l84_report_t *report, uint32_t now_us) {
+  current = *report;
+  update_dirty(now_us);
+}
+
+bool l84_hid_send_next(uint32_t now_us) {
+  // Held mouse keys may be due for another report
+  update_dirty(now_us);
+
+  if (!tud_hid_ready())
+    return false;
+
+  if (tud_hid_get_protocol() == HID_PROTOCOL_BOOT) {
+    // Boot protocol hosts (BIOS, bootloaders) only understand the keyboard
+    // report, without report ID
+    if (!dirty[L84_REPORT_ID_KEYBOARD])
+      return false;
+    if (!tud_hid_keyboard_report(0, 0, current.keycode))
+      return false;
+    memcpy(sent.keycode, current.keycode, sizeof(sent.keycode));
+    dirty[L84_REPORT_ID_KEYBOARD] = false;
+    count_report(0, 8);
+    return true;
+  }
+
+  for (uint8_t id = L84_REPORT_ID_KEYBOARD; id < L84_REPORT_ID_COUNT; ++id) {
+    if (dirty[id])
+      return send_report(id, now_us);
+  }
+  return false;
+}
+
+bool l84_hid_pending() {
+  for (uint8_t id = L84_REPORT_ID_KEYBOARD; id < L84_REPORT_ID_COUNT; ++id) {
+    if (dirty[id])
+      return true;
+  }
+  return false;
+}
+
+bool l84_hid_next_wakeup(uint32_t *wakeup_us) {
+  bool moving = current.mouse_motion & MOUSE_MOVE_BITS;
+  bool scrolling = current.mouse_motion & MOUSE_WHEEL_BITS;
+
+  if (moving && scrolling)
+    *wakeup_us = time_reached(next_move_us, next_wheel_us) ? next_wheel_us
+                                                           : next_move_us;
+  else if (moving)
+    *wakeup_us = next_move_us;
+  else if (scrolling)
+    *wakeup_us = next_wheel_us;
+
+  return moving || scrolling;
+}
+
+void l84_hid_invalidate() {
+  for (uint8_t id = L84_REPORT_ID_KEYBOARD; id < L84_REPORT_ID_COUNT; ++id) {
+    dirty[id] = true;
+  }
+}
+
+void l84_hid_print_stats() {
+  uint32_t total_bytes = 0;
+  for (uint8_t id = 0; id < L84_REPORT_ID_COUNT; ++id) {
+    total_bytes += byte_count[id];
+  }
+
+  printf("HID reports:");
+  for (uint8_t id = 0; id < L84_REPORT_ID_COUNT; ++id) {
+    uint32_t share =
+        total_bytes ? (uint32_t)((100ull * byte_count[id]) / total_bytes) : 0;
+    printf(" %s %lu (%lu%%)", report_name[id], (unsigned long)report_count[id],
+           (unsigned long)share);
+  }
+  printf("\n");
+}
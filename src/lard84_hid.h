@@ -0,0 +1,57 @@
+/*
+** file: lard84_hid.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Scheduling of the HID input reports on the single interrupt IN endpoint.
+** Each report ID has a dirty flag; when the endpoint is free, the dirty
+** report with the highest priority is sent. The keyboard report always comes
+** first, so media keys or mouse movement never hold back a keystroke by more
+** than the one report that may already be in flight.
+*/
+
+#ifndef _LARD84_HID_H
+#define _LARD84_HID_H
+
+#include "lard84_report.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Report IDs, in decreasing priority order
+enum {
+  L84_REPORT_ID_KEYBOARD = 1,
+  L84_REPORT_ID_CONSUMER,
+  L84_REPORT_ID_SYSTEM,
+  L84_REPORT_ID_MOUSE,
+  L84_REPORT_ID_COUNT,
+};
+
+// Vendor-defined feature report, only sent on request over the control
+// endpoint, see lard84_diag.h
+#define L84_REPORT_ID_DIAG 0x10
+// Vendor-defined feature report for firmware updates, see lard84_update.h
+#define L84_REPORT_ID_UPDATE 0x11
+
+// Mouse keys: pointer speed and wheel rate
+#define L84_MOUSE_STEP 4
+#define L84_MOUSE_MOVE_INTERVAL_US 8000
+#define L84_MOUSE_WHEEL_INTERVAL_US 50000
+
+// Mark the reports that differ from what the host last received as dirty
+void l84_hid_update(const l84_report_t *report, uint32_t now_us);
+// Send the highest priority dirty report, if the endpoint is ready.
+// Returns true if a report was sent.
+bool l84_hid_send_next(uint32_t now_us);
+// True if a report is waiting for the endpoint
+bool l84_hid_pending();
+// If held mouse keys need another report later on, set wakeup_us to that
+// time and return true
+bool l84_hid_next_wakeup(uint32_t *wakeup_us);
+// Mark every report dirty, e.g. after (re)enumeration
+void l84_hid_invalidate();
+// Print the number of reports and bytes sent per report ID
+void l84_hid_print_stats();
+
+#endif /* _LARD84_HID_H */
@@ -7,7 +7,8 @@
 */
 
 #include "class/hid/hid.h"
-#include "lard84_keymatrix.h"
+#include "lard84_keycodes.h"
+#include "lard84_keymask.h"
 
 // HID keycode associated to each key
 // Differences with usual ANSI layout:
@@ -128,7 +129,11 @@ const uint32_t l84_hid_keycode[N_ROWS][N_COLS] = {
 
 // Keycode associated with each key, when the function key is also pressed
 // Differences with the table above:
-// - None (TODO(mdu))
+// - Media keys on F1-F3 (mute, volume down/up) and F5-F7 (previous,
+//   play/pause, next)
+// - System sleep on print screen
+// - Mouse keys: pointer on the arrows, wheel on page up/down, left and right
+//   buttons on right alt and right ctrl
 // On lard61, here were the differences:
 // - Backtick (GRAVE) on the top left ESC key
 // - F1-F12 keys on the top layer
@@ -141,19 +146,19 @@ const uint32_t l84_hid_keycode[N_ROWS][N_COLS] = {
 const uint32_t l84_hid_keycode_fn[N_ROWS][N_COLS] = {
     {
         HID_KEY_ESCAPE,
-        HID_KEY_F1,
-        HID_KEY_F2,
-        HID_KEY_F3,
+        L84_KC_CONSUMER(HID_USAGE_CONSUMER_MUTE),
+        L84_KC_CONSUMER(HID_USAGE_CONSUMER_VOLUME_DECREMENT),
+        L84_KC_CONSUMER(HID_USAGE_CONSUMER_VOLUME_INCREMENT),
         HID_KEY_F4,
-        HID_KEY_F5,
-        HID_KEY_F6,
-        HID_KEY_F7,
+        L84_KC_CONSUMER(HID_USAGE_CONSUMER_SCAN_PREVIOUS),
+        L84_KC_CONSUMER(HID_USAGE_CONSUMER_PLAY_PAUSE),
+        L84_KC_CONSUMER(HID_USAGE_CONSUMER_SCAN_NEXT),
         HID_KEY_F8,
         HID_KEY_F9,
         HID_KEY_F10,
         HID_KEY_F11,
         HID_KEY_F12,
-        HID_KEY_PRINT_SCREEN,
+        L84_KC_SYSTEM(HID_USAGE_DESKTOP_SYSTEM_SLEEP),
         HID_KEY_INSERT,
         HID_KEY_DELETE,
     },
@@ -191,7 +196,7 @@ const uint32_t l84_hid_keycode_fn[N_ROWS][N_COLS] = {
         HID_KEY_BRACKET_RIGHT,
         HID_KEY_BACKSLASH,
         HID_KEY_NONE,
-        HID_KEY_PAGE_UP,
+        L84_KC_MOUSE_MOTION(L84_MOUSE_MOTION_WHEEL_UP),
     },
     {
         HID_KEY_CAPS_LOCK,
@@ -209,7 +214,7 @@ const uint32_t l84_hid_keycode_fn[N_ROWS][N_COLS] = {
         HID_KEY_NONE,
         HID_KEY_ENTER,
         HID_KEY_NONE,
-        HID_KEY_PAGE_DOWN,
+        L84_KC_MOUSE_MOTION(L84_MOUSE_MOTION_WHEEL_DOWN),
     },
     {
         HID_KEY_SHIFT_LEFT,
@@ -226,7 +231,7 @@ const uint32_t l84_hid_keycode_fn[N_ROWS][N_COLS] = {
         HID_KEY_SLASH,
         HID_KEY_NONE,
         HID_KEY_SHIFT_RIGHT,
-        HID_KEY_ARROW_UP,
+        L84_KC_MOUSE_MOTION(L84_MOUSE_MOTION_UP),
         HID_KEY_END,
     },
     {
@@ -241,16 +246,35 @@ const uint32_t l84_hid_keycode_fn[N_ROWS][N_COLS] = {
         HID_KEY_NONE,
         HID_KEY_NONE,
         HID_KEY_NONE,
-        HID_KEY_ALT_RIGHT,
+        L84_KC_MOUSE_BUTTON(L84_MOUSE_BUTTON_LEFT),
         HID_KEY_NONE, // Function/layer key, handled in
                       // l84_keymatrix_is_fn_key_pressed
-        HID_KEY_CONTROL_RIGHT,
-        HID_KEY_ARROW_LEFT,
-        HID_KEY_ARROW_DOWN,
-        HID_KEY_ARROW_RIGHT,
+        L84_KC_MOUSE_BUTTON(L84_MOUSE_BUTTON_RIGHT),
+        L84_KC_MOUSE_MOTION(L84_MOUSE_MOTION_LEFT),
+        L84_KC_MOUSE_MOTION(L84_MOUSE_MOTION_DOWN),
+        L84_KC_MOUSE_MOTION(L84_MOUSE_MOTION_RIGHT),
     },
 };
 
+// Combos: keys pressed together within L84_COMBO_TERM_US
+// Only keys that are never held together while typing are used, since combo
+// keys are held back for up to the combo window before being sent.
+// F10+F11 and F10+F11+F12 overlap: F10+F11 waits for F12 until the window
+// closes.
+const l84_combo_def_t l84_default_combos[] = {
+    // F11 + F12: Pause, which has no key of its own on the lard84
+    {{L84_KEY_INDEX(11, 0), L84_KEY_INDEX(12, 0)}, 2, HID_KEY_PAUSE},
+    // F10 + F11: Scroll lock
+    {{L84_KEY_INDEX(10, 0), L84_KEY_INDEX(11, 0)}, 2, HID_KEY_SCROLL_LOCK},
+    // F10 + F11 + F12: Application (context menu) key
+    {{L84_KEY_INDEX(10, 0), L84_KEY_INDEX(11, 0), L84_KEY_INDEX(12, 0)},
+     3,
+     HID_KEY_APPLICATION},
+};
+
+const uint8_t l84_num_default_combos =
+    sizeof(l84_default_combos) / sizeof(l84_default_combos[0]);
+
 uint32_t l84_keycode_get(uint8_t col, uint8_t row, bool fn_layer) {
   if (fn_layer)
     return l84_hid_keycode_fn[row][col];
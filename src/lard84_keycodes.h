@@ -9,12 +9,49 @@
 #ifndef _LARD84_KEYCODES_H
 #define _LARD84_KEYCODES_H
 
+#include "lard84_combo.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 //-----------------------------------------------------------------------------
 // Public API
 //-----------------------------------------------------------------------------
 
+// Keycodes up to 0xff are keyboard usages. Above that, bits 16 and up select
+// which HID report the usage in the low 16 bits belongs to.
+#define L84_KC_TYPE_KEYBOARD 0
+#define L84_KC_TYPE_CONSUMER 1
+#define L84_KC_TYPE_SYSTEM 2
+#define L84_KC_TYPE_MOUSE 3
+
+#define L84_KC_TYPE(kc) ((kc) >> 16)
+#define L84_KC_USAGE(kc) ((kc) & 0xffff)
+
+// Consumer control usage, e.g. HID_USAGE_CONSUMER_VOLUME_INCREMENT
+#define L84_KC_CONSUMER(usage) ((L84_KC_TYPE_CONSUMER << 16) | (usage))
+// System control usage, e.g. HID_USAGE_DESKTOP_SYSTEM_SLEEP
+#define L84_KC_SYSTEM(usage) ((L84_KC_TYPE_SYSTEM << 16) | (usage))
+// Mouse keys: buttons in the low byte, motion in the high byte
+#define L84_KC_MOUSE_BUTTON(button) ((L84_KC_TYPE_MOUSE << 16) | (button))
+#define L84_KC_MOUSE_MOTION(motion)                                            \
+  ((L84_KC_TYPE_MOUSE << 16) | ((motion) << 8))
+
+// Same bits as the HID mouse report
+#define L84_MOUSE_BUTTON_LEFT 0x01
+#define L84_MOUSE_BUTTON_RIGHT 0x02
+#define L84_MOUSE_BUTTON_MIDDLE 0x04
+
+#define L84_MOUSE_MOTION_UP 0x01
+#define L84_MOUSE_MOTION_DOWN 0x02
+#define L84_MOUSE_MOTION_LEFT 0x04
+#define L84_MOUSE_MOTION_RIGHT 0x08
+#define L84_MOUSE_MOTION_WHEEL_UP 0x10
+#define L84_MOUSE_MOTION_WHEEL_DOWN 0x20
+
 uint32_t l84_keycode_get(uint8_t col, uint8_t row, bool fn_layer);
 
+// Combos of the default keymap, see lard84_combo.h
+extern const l84_combo_def_t l84_default_combos[];
+extern const uint8_t l84_num_default_combos;
+
 #endif /* _LARD84_KEYCODES_H */
\ No newline at end of file
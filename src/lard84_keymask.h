@@ -0,0 +1,85 @@
+/*
+** file: lard84_keymask.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Dimensions of the key matrix, flat key indices and key bitmasks.
+** This header only depends on the C standard library and the generated
+** board header, so that the input pipeline (key order, report building) can
+** also be compiled on a host.
+*/
+
+#ifndef _LARD84_KEYMASK_H
+#define _LARD84_KEYMASK_H
+
+#include "lard84_board.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// From the board description, see boards/*.json
+#define N_ROWS L84_BOARD_N_ROWS
+#define N_COLS L84_BOARD_N_COLS
+
+// Total number of positions in the key matrix
+#define N_KEYS (N_ROWS * N_COLS)
+
+// Flat index of the key at (col, row), in [0, N_KEYS)
+// Keys are numbered in scan order: column-major, like the keymatrix state.
+#define L84_KEY_INDEX(col, row) ((uint8_t)((col) * N_ROWS + (row)))
+#define L84_KEY_COL(key) ((key) / N_ROWS)
+#define L84_KEY_ROW(key) ((key) % N_ROWS)
+
+// Virtual keys follow the matrix keys. They are not wired to a switch but
+// pressed/released by the input pipeline, e.g. when a combo fires.
+#define L84_N_VIRTUAL_KEYS 16
+#define L84_KEY_VIRTUAL(i) ((uint8_t)(N_KEYS + (i)))
+#define L84_N_KEY_IDS (N_KEYS + L84_N_VIRTUAL_KEYS)
+
+// One bit per key of the matrix and per virtual key, indexed by flat key index
+#define L84_KEYMASK_WORDS ((L84_N_KEY_IDS + 31) / 32)
+
+typedef struct {
+  uint32_t w[L84_KEYMASK_WORDS];
+} l84_keymask_t;
+
+static inline bool l84_keymask_test(const l84_keymask_t *mask, uint8_t key) {
+  return (mask->w[key >> 5] >> (key & 31)) & 1u;
+}
+
+static inline void l84_keymask_set(l84_keymask_t *mask, uint8_t key) {
+  mask->w[key >> 5] |= 1u << (key & 31);
+}
+
+static inline void l84_keymask_clear(l84_keymask_t *mask, uint8_t key) {
+  mask->w[key >> 5] &= ~(1u << (key & 31));
+}
+
+static inline bool l84_keymask_is_empty(const l84_keymask_t *mask) {
+  uint32_t any = 0;
+  for (int i = 0; i < L84_KEYMASK_WORDS; ++i)
+    any |= mask->w[i];
+  return any == 0;
+}
+
+static inline bool l84_keymask_equal(const l84_keymask_t *a,
+                                     const l84_keymask_t *b) {
+  uint32_t diff = 0;
+  for (int i = 0; i < L84_KEYMASK_WORDS; ++i)
+    diff |= a->w[i] ^ b->w[i];
+  return diff == 0;
+}
+
+// True if every key of sub is also in mask
+static inline bool l84_keymask_contains(const l84_keymask_t *mask,
+                                        const l84_keymask_t *sub) {
+  uint32_t missing = 0;
+  for (int i = 0; i < L84_KEYMASK_WORDS; ++i)
+    missing |= sub->w[i] & ~mask->w[i];
+  return missing == 0;
+}
+
+#endif /* _LARD84_KEYMASK_H */
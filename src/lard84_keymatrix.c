@@ -7,6 +7,12 @@
 #include "lard84_keymatrix.h"
 
 #include "hardware/gpio.h"
+#include "lard84_board_scan.h"
+#include "lard84_boot.h"
+#include "lard84_combo.h"
+#include "lard84_cycles.h"
+#include "lard84_debounce.h"
+#include "lard84_keystats.h"
 #include "pico/time.h"
 #include "pico/types.h"
 #include <pico/mutex.h>
@@ -18,114 +24,85 @@
 // Static variables
 //-----------------------------------------------------------------------------
 
-// Minimum time between a key being first pressed/released and the
-// moment it is registered
-#define DEBOUNCE_THRESHOLD_CYCLES 5
-
-// The following arrays are slightly larger than they need to be: we only
-// have 84 physical keys. This is just more convenient for looping over
-// rows and columns.
-
-// Keys that are registered as pressed, after debouncing
-bool pressed[N_COLS][N_ROWS] = {0};
-
-// Number of l84_keymatrix_poll calls that a given key is pressed.
-// When the number exceeds DEBOUNCE_THRESHOLD_CYCLES, the key
-// registers as pressed.
-uint num_pressed_cycles[N_COLS][N_ROWS] = {0};
-
-// Position of the Fn key
-#define L84_FN_COL 11
-#define L84_FN_ROW 5
-
-// GPIO pins for each row
-static const uint row_pin[N_ROWS] = {
-    1,  // row1 /* NOTE(mdu) enable uart on pins 0, 1 by setting this to 30
-    29, // row2
-    2,  // row3
-    28, // row4
-    27, // row5
-    26, // row6
-};
-
-// GPIO pins for each column
-static const uint col_pin[N_COLS] = {
-    18, // col1
-    19, // col2
-    20, // col3
-    21, // col4
-    22, // col5
-    23, // col6
-    24, // col7
-    25, // col8
-    3,  // col9
-    5,  // col10
-    6,  // col11
-    7,  // col12
-    8,  // col13
-    9,  // col14
-    10, // col15
-    11, // col16
-};
+// State of the Fn key as seen by core0, only updated under the mutex along
+// with the key order. The debounced state itself changes outside of it.
+static volatile bool fn_pressed = false;
 
 //-----------------------------------------------------------------------------
 // Public API
 //-----------------------------------------------------------------------------
 
 void l84_keymatrix_setup() {
-  // Set all row pins as input
-  for (uint row = 0; row < N_ROWS; ++row) {
-    gpio_init(row_pin[row]);
-    printf("Row input: pin %d\n", row_pin[row]);
-  }
-
-  // Set all column pins as output
-  for (uint col = 0; col < N_COLS; ++col) {
-    gpio_init(col_pin[col]);
-    gpio_set_dir(col_pin[col], GPIO_OUT);
-    printf("Col output: pin %d\n", col_pin[col]);
-  }
-
-  printf("Key matrix pins configured\n");
+  // Rows are inputs, columns outputs. Pins come from the board description,
+  // see boards/*.json and tools/gen_board.py
+  gpio_init_mask(L84_BOARD_ROW_MASK | L84_BOARD_COL_MASK);
+  gpio_set_dir_out_masked(L84_BOARD_COL_MASK);
+  // Row inputs: the scan resets them after each column, and waits for the
+  // rows to settle before reading, which also covers the input synchronizers
+  l84_board_rows_input_enable();
+
+  // A single line: this runs at boot, and the UART is slow enough for a line
+  // per pin to hold up the first scan by tens of milliseconds
+  printf("Key matrix pins configured (board %s, %d rows, %d cols)\n",
+         L84_BOARD_NAME, N_ROWS, N_COLS);
 }
 
 void l84_keymatrix_poll(mutex_t *mutex) {
-  // Turn each column high, poll rows
+  // Turn each column high, poll rows. The scan is generated for the board,
+  // fully unrolled, see lard84_board_scan.h
+  // NOTE(mdu) the row pins' inputs are reset after each column, due to
+  // Errata E9 on the RP2350 datasheet. Basically, an input pin driven high
+  // will stick high, and the documented way to fix this in software is to
+  // reset the input-enabled state. Left until the end of the scan, a row
+  // latched by one column would read high for all the following ones.
+  uint8_t col_rows[N_COLS];
+  l84_board_scan(col_rows);
+
+  // Debouncing state is private to this core
+  l84_debounce_event_t events[L84_DEBOUNCE_MAX_EVENTS];
+  uint8_t n_events = l84_debounce_update(col_rows, events);
+
+  // Keys held since power up are registered by now
+  static uint num_polls = 0;
+  if (num_polls++ == L84_DEBOUNCE_THRESHOLD_SCANS)
+    l84_boot_mark(L84_BOOT_MATRIX_READY);
+
+  // Releasing the mutex sends an event to the other core, which wakes core0
+  // up from its sleep: only take it when the shared state may change.
+  if (n_events == 0 && !l84_combo_is_waiting())
+    return;
 
   mutex_enter_blocking(mutex);
 
-  for (uint col = 0; col < N_COLS; ++col) {
-    // Send the high signal in the active column
-    gpio_put(col_pin[col], true);
-
-    for (uint row = 0; row < N_ROWS; ++row) {
-      // NOTE(mdu) enabling and disabling the input on our row pins
-      // is necessary due to Errata E9 on the RP2350 datasheet.
-      // Basically, an input pin driven high will stick high, and
-      // the documented way to fix this in software is to reset the
-      // input-enabled state.
-      gpio_set_input_enabled(row_pin[row], true);
-      bool state = gpio_get(row_pin[row]);
-      gpio_set_input_enabled(row_pin[row], false);
-
-      if (state) {
-        num_pressed_cycles[col][row] += 1;
-
-        if (num_pressed_cycles[col][row] > DEBOUNCE_THRESHOLD_CYCLES) {
-          pressed[col][row] = true;
-        }
-      } else {
-        num_pressed_cycles[col][row] = 0;
-        pressed[col][row] = false;
-      }
+  const uint32_t now_us = time_us_32();
+
+  for (uint8_t i = 0; i < n_events; ++i) {
+    const uint8_t key = events[i].key;
+    uint32_t stats_start;
+
+    switch (events[i].edge) {
+    case L84_DEBOUNCE_PRESS:
+      l84_combo_on_press(key, now_us);
+
+      stats_start = l84_cycles_now();
+      l84_keystats_on_press(key);
+      l84_keystats_add_cost(l84_cycles_now() - stats_start);
+      break;
+    case L84_DEBOUNCE_RELEASE:
+      l84_combo_on_release(key, now_us);
+      break;
+    case L84_DEBOUNCE_CHATTER:
+      stats_start = l84_cycles_now();
+      l84_keystats_on_chatter(key);
+      l84_keystats_add_cost(l84_cycles_now() - stats_start);
+      break;
     }
+  }
 
-    gpio_put(col_pin[col], false);
+  // Let go of combo keys that were held back for too long
+  l84_combo_task(now_us);
 
-    // Sufficient for this column to be low before the next iteration
-    // Without this, we get false inputs on the next column.
-    sleep_us(2);
-  }
+  fn_pressed = l84_debounce_is_pressed(L84_BOARD_FN_COL, L84_BOARD_FN_ROW);
 
   mutex_exit(mutex);
 }
@@ -135,7 +112,7 @@ void l84_keymatrix_report() {
   for (uint col = 0; col < N_COLS; ++col) {
     for (uint row = 0; row < N_ROWS; ++row) {
       // Check the pressed table and update
-      if (pressed[col][row]) {
+      if (l84_debounce_is_pressed(col, row)) {
         printf("pressed %d %d\n", col + 1, row + 1);
       }
     }
@@ -143,9 +120,7 @@ void l84_keymatrix_report() {
 }
 
 bool l84_keymatrix_is_key_pressed(uint col, uint row) {
-  return pressed[col][row];
+  return l84_debounce_is_pressed(col, row);
 }
 
-bool l84_keymatrix_is_fn_key_pressed() {
-  return l84_keymatrix_is_key_pressed(L84_FN_COL, L84_FN_ROW);
-}
\ No newline at end of file
+bool l84_keymatrix_is_fn_key_pressed() { return fn_pressed; }
\ No newline at end of file
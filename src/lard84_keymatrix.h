@@ -7,6 +7,7 @@
 #ifndef _LARD84_KEYMATRIX_H
 #define _LARD84_KEYMATRIX_H
 
+#include "lard84_keymask.h"
 #include "pico/types.h"
 #include <pico/mutex.h>
 
@@ -14,20 +15,21 @@
 // Public API
 //-----------------------------------------------------------------------------
 
-#define N_ROWS 6
-#define N_COLS 16
-
 // Setup GPIOs of the key matrix
 void l84_keymatrix_setup();
 // Query the state of all keys on the keyboard
-// Mutex should be acquired for read/write access to the keymatrix state
+// Debounced press/release edges are forwarded to the combo engine, then to
+// the key order list.
+// Mutex should be acquired for read/write access to the keymatrix state.
+// It is only taken when keys changed or the combo engine is waiting.
 void l84_keymatrix_poll(mutex_t *mutex);
 // Print out what keys are pressed according to the last call
 // to l84_keymatrix_update
 void l84_keymatrix_report();
 // Returns true if switch at index is pressed down
 bool l84_keymatrix_is_key_pressed(uint col, uint row);
-// Returns true if the Fn/layer key is pressed
+// Returns true if the Fn/layer key is pressed, as of the last key order
+// update. Mutex should be held, like for the key order.
 bool l84_keymatrix_is_fn_key_pressed();
 
 #endif /* _LARD84_KEYMATRIX_H */
\ No newline at end of file
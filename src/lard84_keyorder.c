@@ -0,0 +1,79 @@
+/*
+** file: lard84_keyorder.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** List of the keys currently held down, in the order they were pressed.
+*/
+
+#include "lard84_keyorder.h"
+
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Held keys, oldest first. Presses append at the end, releases shift the
+// younger entries down by one. The list is short in practice (a handful of
+// keys), so the shift is cheaper than maintaining a linked list.
+static l84_keyorder_entry_t entries[L84_N_KEY_IDS];
+static uint8_t num_entries = 0;
+
+// Keys currently in the list, to make duplicate presses/releases cheap to
+// reject and to give the report pipeline a bitmask view of the list
+static l84_keymask_t held = {0};
+
+// Press counter and the value it had at the last press of each key
+static uint32_t press_counter = 0;
+static uint32_t press_seq[L84_N_KEY_IDS] = {0};
+
+static uint32_t generation = 0;
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_keyorder_clear() {
+  num_entries = 0;
+  memset(&held, 0, sizeof(held));
+  generation++;
+}
+
+void l84_keyorder_press(uint8_t key, uint32_t time_us) {
+  if (key >= L84_N_KEY_IDS || l84_keymask_test(&held, key))
+    return;
+
+  l84_keymask_set(&held, key);
+  press_seq[key] = ++press_counter;
+  entries[num_entries].key = key;
+  entries[num_entries].time_us = time_us;
+  num_entries++;
+  generation++;
+}
+
+void l84_keyorder_release(uint8_t key) {
+  if (key >= L84_N_KEY_IDS || !l84_keymask_test(&held, key))
+    return;
+
+  l84_keymask_clear(&held, key);
+  generation++;
+  for (uint8_t i = 0; i < num_entries; ++i) {
+    if (entries[i].key == key) {
+      memmove(&entries[i], &entries[i + 1],
+              (num_entries - i - 1) * sizeof(entries[0]));
+      num_entries--;
+      return;
+    }
+  }
+}
+
+uint8_t l84_keyorder_count() { return num_entries; }
+
+const l84_keyorder_entry_t *l84_keyorder_entries() { return entries; }
+
+const l84_keymask_t *l84_keyorder_mask() { return &held; }
+
+uint32_t l84_keyorder_press_seq(uint8_t key) { return press_seq[key]; }
+
+uint32_t l84_keyorder_generation() { return generation; }
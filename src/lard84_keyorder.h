@@ -0,0 +1,46 @@
+/*
+** file: lard84_keyorder.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** List of the keys currently held down, in the order they were pressed.
+** The list is updated incrementally on debounced key edges, so reports
+** never need to rebuild it from the whole matrix.
+*/
+
+#ifndef _LARD84_KEYORDER_H
+#define _LARD84_KEYORDER_H
+
+#include "lard84_keymask.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+typedef struct {
+  // Flat key index, see L84_KEY_INDEX and L84_KEY_VIRTUAL
+  uint8_t key;
+  // Time of the debounced press edge, in microseconds since boot
+  uint32_t time_us;
+} l84_keyorder_entry_t;
+
+// Forget all held keys
+void l84_keyorder_clear();
+// Register a key press. Pressing a key that is already held is a no-op.
+void l84_keyorder_press(uint8_t key, uint32_t time_us);
+// Register a key release. Releasing a key that is not held is a no-op.
+void l84_keyorder_release(uint8_t key);
+// Number of keys currently held
+uint8_t l84_keyorder_count();
+// Held keys, oldest press first. Valid for l84_keyorder_count() entries,
+// until the next call to l84_keyorder_press/release.
+const l84_keyorder_entry_t *l84_keyorder_entries();
+// Bitmask of the keys currently held
+const l84_keymask_t *l84_keyorder_mask();
+// Sequence number of the last press of key. Later presses have larger
+// numbers, so comparing two held keys tells which was pressed last.
+uint32_t l84_keyorder_press_seq(uint8_t key);
+// Incremented every time the list changes
+uint32_t l84_keyorder_generation();
+
+#endif /* _LARD84_KEYORDER_H */
@@ -0,0 +1,302 @@
+/*
+** file: lard84_keystats.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Per-key press and chatter counters, persisted in a flash log.
+**
+** The log lives in the last two sectors of flash, as fixed-size records.
+** Each record holds the complete totals and a sequence number; the valid
+** record with the highest sequence number is the current one. Records are
+** appended, and a sector is only erased when the log wraps around into it,
+** by which time the other sector holds the latest record.
+*/
+
+#include "lard84_keystats.h"
+
+#include "lard84_clock.h"
+#include "lard84_diag.h"
+#include "lard84_flash.h"
+#include "pico/mutex.h"
+#include "pico/time.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+#define LOG_OFFSET L84_KEYSTATS_FLASH_OFFSET
+#define LOG_N_SECTORS ((PICO_FLASH_SIZE_BYTES - LOG_OFFSET) / FLASH_SECTOR_SIZE)
+#define RECORD_SIZE 1024
+#define RECORDS_PER_SECTOR (FLASH_SECTOR_SIZE / RECORD_SIZE)
+#define LOG_N_RECORDS (LOG_N_SECTORS * RECORDS_PER_SECTOR)
+#define RECORD_MAGIC 0x5453344cu // "L4ST"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t press[N_KEYS];
+  uint16_t chatter[N_KEYS];
+  uint32_t checksum;
+} record_t;
+
+_Static_assert(sizeof(record_t) <= RECORD_SIZE, "keystats record too large");
+
+// Pending counts since the last flush, written by core1
+static uint16_t press_pending[N_KEYS] = {0};
+static uint8_t chatter_pending[N_KEYS] = {0};
+// Incremented on every update, so core0 can tell when the keys went idle
+static volatile uint32_t num_updates = 0;
+// Set when a pending counter is past 3/4 of its range
+static volatile bool near_saturation = false;
+
+// Latest record in flash, or -1 if the log is empty
+static int latest_slot = -1;
+static uint32_t latest_seq = 0;
+
+// Slot the next record goes to
+static int next_slot = 0;
+
+// Core0 side: pending counts not written yet, time of the last update seen,
+// time of the last flush attempt (nil until the first one). 64 bit times:
+// the flush interval is close to the wrap of the 32 bit microsecond timer.
+static bool dirty = false;
+static uint32_t last_update_count = 0;
+static absolute_time_t last_update = 0;
+static absolute_time_t last_flush = nil_time;
+static uint32_t num_flushes = 0;
+
+// Flash writes run at the burst operating point, for at most this long
+#define FLUSH_BURST_US 100000
+
+// Cost of the updates on core1
+static uint32_t cost_max = 0;
+static uint64_t cost_sum = 0;
+static uint32_t cost_count = 0;
+
+// Staging buffer for the record being written
+static uint8_t record_buf[RECORD_SIZE] __attribute__((aligned(4)));
+
+// Diagnostics topic: 4 byte header (rows, cols, 0, 0), then per key in flat
+// index order, a 32 bit press total and a 16 bit chatter total
+#define TOPIC_HEADER_SIZE 4
+#define TOPIC_KEY_SIZE 6
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static uint32_t record_offset(int slot) {
+  return LOG_OFFSET + (uint32_t)slot * RECORD_SIZE;
+}
+
+static const record_t *record_at(int slot) {
+  return l84_flash_read_ptr(record_offset(slot));
+}
+
+// FNV-1a over the record, up to the checksum
+static uint32_t record_checksum(const record_t *r) {
+  const uint8_t *p = (const uint8_t *)r;
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < offsetof(record_t, checksum); ++i) {
+    h = (h ^ p[i]) * 16777619u;
+  }
+  return h;
+}
+
+static bool record_valid(const record_t *r) {
+  return r->magic == RECORD_MAGIC && r->checksum == record_checksum(r);
+}
+
+static bool slot_blank(int slot) {
+  const uint32_t *w = (const uint32_t *)record_at(slot);
+  for (size_t i = 0; i < RECORD_SIZE / sizeof(uint32_t); ++i) {
+    if (w[i] != 0xffffffffu)
+      return false;
+  }
+  return true;
+}
+
+static void find_latest() {
+  latest_slot = -1;
+  for (int slot = 0; slot < LOG_N_RECORDS; ++slot) {
+    const record_t *r = record_at(slot);
+    if (!record_valid(r))
+      continue;
+    if (latest_slot < 0 || (int32_t)(r->seq - latest_seq) > 0) {
+      latest_slot = slot;
+      latest_seq = r->seq;
+    }
+  }
+  next_slot = latest_slot >= 0 ? (latest_slot + 1) % LOG_N_RECORDS : 0;
+}
+
+static uint32_t total_press(uint8_t key) {
+  uint32_t t = latest_slot >= 0 ? record_at(latest_slot)->press[key] : 0;
+  return t + press_pending[key];
+}
+
+static uint16_t total_chatter(uint8_t key) {
+  uint32_t t = latest_slot >= 0 ? record_at(latest_slot)->chatter[key] : 0;
+  t += chatter_pending[key];
+  return t > 0xffff ? 0xffff : (uint16_t)t;
+}
+
+static uint16_t topic_size() {
+  return TOPIC_HEADER_SIZE + N_KEYS * TOPIC_KEY_SIZE;
+}
+
+static void topic_read(uint16_t offset, uint8_t *buf, uint16_t len) {
+  for (uint16_t i = 0; i < len; ++i) {
+    uint16_t pos = offset + i;
+    if (pos < TOPIC_HEADER_SIZE) {
+      const uint8_t header[TOPIC_HEADER_SIZE] = {N_ROWS, N_COLS, 0, 0};
+      buf[i] = header[pos];
+      continue;
+    }
+    pos -= TOPIC_HEADER_SIZE;
+    uint8_t key = pos / TOPIC_KEY_SIZE;
+    uint8_t byte = pos % TOPIC_KEY_SIZE;
+    if (byte < 4)
+      buf[i] = (total_press(key) >> (8 * byte)) & 0xff;
+    else
+      buf[i] = (total_chatter(key) >> (8 * (byte - 4))) & 0xff;
+  }
+}
+
+// Add the pending counts to the latest totals, and append the result to the
+// log. Returns false if the record could not be written.
+static bool flush(mutex_t *mutex) {
+  record_t *r = (record_t *)record_buf;
+  memset(record_buf, 0xff, sizeof(record_buf));
+
+  const record_t *prev = latest_slot >= 0 ? record_at(latest_slot) : NULL;
+
+  // Take the pending counts in one go, so core1 is only held up for a copy
+  uint16_t press[N_KEYS];
+  uint8_t chatter[N_KEYS];
+  mutex_enter_blocking(mutex);
+  memcpy(press, press_pending, sizeof(press));
+  memcpy(chatter, chatter_pending, sizeof(chatter));
+  memset(press_pending, 0, sizeof(press_pending));
+  memset(chatter_pending, 0, sizeof(chatter_pending));
+  near_saturation = false;
+  mutex_exit(mutex);
+
+  for (uint8_t key = 0; key < N_KEYS; ++key) {
+    uint32_t p = prev ? prev->press[key] : 0;
+    r->press[key] = p + press[key] < p ? UINT32_MAX : p + press[key];
+    uint32_t c = (prev ? prev->chatter[key] : 0) + chatter[key];
+    r->chatter[key] = c > 0xffff ? 0xffff : (uint16_t)c;
+  }
+  r->magic = RECORD_MAGIC;
+  r->seq = latest_slot >= 0 ? latest_seq + 1 : 0;
+  r->checksum = record_checksum(r);
+
+  // Skip slots left half-written by a reset. Sector starts are always erased
+  // first, and never hold the latest record when we get to them.
+  while (next_slot % RECORDS_PER_SECTOR != 0 && !slot_blank(next_slot))
+    next_slot = (next_slot + 1) % LOG_N_RECORDS;
+
+  const int slot = next_slot;
+  bool ok = true;
+  if (slot % RECORDS_PER_SECTOR == 0)
+    ok = l84_flash_erase(record_offset(slot), FLASH_SECTOR_SIZE);
+  if (ok)
+    ok = l84_flash_program(record_offset(slot), record_buf, RECORD_SIZE);
+
+  if (ok && record_valid(record_at(slot))) {
+    latest_slot = slot;
+    latest_seq = r->seq;
+    next_slot = (slot + 1) % LOG_N_RECORDS;
+    num_flushes++;
+    return true;
+  }
+
+  // Nothing was written (core1 could not be paused in time), or the record
+  // did not read back: keep the counts for the next attempt
+  mutex_enter_blocking(mutex);
+  for (uint8_t key = 0; key < N_KEYS; ++key) {
+    uint32_t p = press_pending[key] + press[key];
+    press_pending[key] = p > 0xffff ? 0xffff : p;
+    uint32_t c = chatter_pending[key] + chatter[key];
+    chatter_pending[key] = c > 0xff ? 0xff : c;
+  }
+  mutex_exit(mutex);
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_keystats_init() {
+  find_latest();
+  l84_diag_register(L84_DIAG_TOPIC_KEYSTATS, topic_size, topic_read);
+}
+
+void l84_keystats_on_press(uint8_t key) {
+  uint16_t n = press_pending[key] + 1;
+  if (n) {
+    press_pending[key] = n;
+    if (n >= 0xc000)
+      near_saturation = true;
+  }
+  num_updates++;
+}
+
+void l84_keystats_on_chatter(uint8_t key) {
+  uint8_t n = chatter_pending[key] + 1;
+  if (n) {
+    chatter_pending[key] = n;
+    if (n >= 0xc0)
+      near_saturation = true;
+  }
+  num_updates++;
+}
+
+void l84_keystats_add_cost(uint32_t cycles) {
+  if (cycles > cost_max)
+    cost_max = cycles;
+  cost_sum += cycles;
+  cost_count++;
+}
+
+void l84_keystats_task(mutex_t *mutex, absolute_time_t now) {
+  uint32_t updates = num_updates;
+  if (updates != last_update_count) {
+    last_update_count = updates;
+    last_update = now;
+    dirty = true;
+    return;
+  }
+
+  if (!dirty || absolute_time_diff_us(last_update, now) < L84_KEYSTATS_IDLE_US)
+    return;
+
+  if (!near_saturation && !is_nil_time(last_flush) &&
+      absolute_time_diff_us(last_flush, now) < L84_KEYSTATS_FLUSH_INTERVAL_US)
+    return;
+
+  // Erasing and programming go faster at the burst operating point, and
+  // hold up core1 for less time. Flush once the clock has gone up.
+  l84_clock_request_burst((uint32_t)to_us_since_boot(now), FLUSH_BURST_US);
+  if (l84_clock_get_level() != L84_CLOCK_BURST)
+    return;
+
+  // On failure, try again after another idle period
+  if (flush(mutex))
+    dirty = false;
+  last_flush = now;
+  last_update = now;
+}
+
+void l84_keystats_print_stats() {
+  printf("Keystats: update cost max %lu cycles (avg %lu), %lu flushes, "
+         "latest record %d\n",
+         (unsigned long)cost_max,
+         (unsigned long)(cost_count ? cost_sum / cost_count : 0),
+         (unsigned long)num_flushes, latest_slot);
+}
@@ -0,0 +1,54 @@
+/*
+** file: lard84_keystats.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Per-key press and chatter counters.
+** Core1 counts debounced presses and rejected bounces in small saturating
+** counters in RAM. Core0 adds them to the totals stored in a flash log, in
+** one batch, only when the keyboard has been idle for a while.
+** The totals can be read from the host as the L84_DIAG_TOPIC_KEYSTATS
+** diagnostics topic.
+*/
+
+#ifndef _LARD84_KEYSTATS_H
+#define _LARD84_KEYSTATS_H
+
+#include "hardware/flash.h"
+#include "lard84_keymask.h"
+#include "pico/types.h"
+#include <pico/mutex.h>
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// The log lives in the last sectors of flash, outside the firmware partitions
+#define L84_KEYSTATS_FLASH_OFFSET                                              \
+  (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE)
+
+// Idle time before pending counts may be written to flash
+#define L84_KEYSTATS_IDLE_US (30 * 1000000ll)
+// Pending counts are written at most this often, unless a counter is close
+// to saturating. The first flush after boot only waits for the idle time.
+#define L84_KEYSTATS_FLUSH_INTERVAL_US (3600 * 1000000ll)
+
+// Load the totals from flash and register the diagnostics topic
+void l84_keystats_init();
+
+// Called by the keymatrix on core1, with the keymatrix mutex held
+// Debounced press edge
+void l84_keystats_on_press(uint8_t key);
+// Raw contact that did not last long enough to register as a press
+void l84_keystats_on_chatter(uint8_t key);
+// Record the cost of an update, in CPU cycles
+void l84_keystats_add_cost(uint32_t cycles);
+
+// Write pending counts to flash when it is a good time to. Core0 only.
+// The keymatrix mutex is taken briefly to collect the pending counts.
+// Requests the burst operating point, and writes once it is reached.
+void l84_keystats_task(mutex_t *mutex, absolute_time_t now);
+// Print the update cost and the flash log state
+void l84_keystats_print_stats();
+
+#endif /* _LARD84_KEYSTATS_H */
@@ -0,0 +1,160 @@
+/*
+** file: lard84_led.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** LED effects streamed to the PWM compare register by DMA.
+**
+** The DMA channel is paced by the wrap DREQ of the LED's PWM slice: every
+** time the PWM counter wraps, one entry of the effect's lookup table is
+** written to the compare register, which only latches it at the next wrap so
+** there is no glitch. The read address wraps around the table (DMA ring),
+** and the transfer count never runs out, so effects loop on their own.
+*/
+
+#include "lard84_led.h"
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// PWM counter wraps after this value: 10 bits of brightness
+#define LED_PWM_TOP 1023
+// PWM periods per second, i.e. lookup table entries played per second
+#define LED_FRAME_HZ 1000
+// The LED is very bright at full duty cycle. Same cap as the old linear fade
+// (64/512).
+#define LED_MAX_LEVEL ((LED_PWM_TOP + 1) / 8)
+#define LED_GAMMA 2.2f
+
+// Breathing table, fade in then out. The DMA ring wraps on a power of two
+// number of bytes, and the buffer must be aligned to that size.
+// 1024 entries at LED_FRAME_HZ is a period of about one second.
+#define BREATHE_RING_BITS 11
+#define BREATHE_LEN ((1u << BREATHE_RING_BITS) / sizeof(uint16_t))
+
+static uint16_t breathe_lut[BREATHE_LEN]
+    __attribute__((aligned(1 << BREATHE_RING_BITS)));
+
+// Constant effects are single entry tables, with a 2 byte ring
+#define CONSTANT_RING_BITS 1
+static uint16_t solid_lut[1] __attribute__((aligned(2))) = {LED_MAX_LEVEL};
+static uint16_t off_lut[1] __attribute__((aligned(2))) = {0};
+
+static int dma_chan = -1;
+static uint slice_num;
+
+static l84_led_effect_t effect = L84_LED_EFFECT_BREATHE;
+static bool caps_lock = false;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+// Divider from clk_sys to the PWM counter, for LED_FRAME_HZ wraps per second
+static float pwm_clkdiv() {
+  return (float)clock_get_hz(clk_sys) / ((LED_PWM_TOP + 1) * LED_FRAME_HZ);
+}
+
+static void fill_breathe_lut() {
+  // Triangle wave in perceived brightness, converted to duty cycle
+  for (uint i = 0; i < BREATHE_LEN; ++i) {
+    float x = (float)i / (BREATHE_LEN / 2);
+    if (x > 1.f)
+      x = 2.f - x;
+    breathe_lut[i] = (uint16_t)(LED_MAX_LEVEL * powf(x, LED_GAMMA) + 0.5f);
+  }
+}
+
+// Start streaming lut, a table of 2^ring_bits bytes, into the PWM compare
+// register
+static void play(const uint16_t *lut, uint ring_bits) {
+  dma_channel_abort(dma_chan);
+
+  dma_channel_config c = dma_channel_get_default_config(dma_chan);
+  // Halfword writes to the compare register are replicated to both
+  // channels of the slice, only the LED channel is routed to a pin
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_ring(&c, false, ring_bits);
+  channel_config_set_dreq(&c, pwm_get_dreq(slice_num));
+
+#if PICO_RP2350
+  const uint32_t transfer_count = dma_encode_endless_transfer_count();
+#else
+  const uint32_t transfer_count = 0xffffffff;
+#endif
+
+  dma_channel_configure(dma_chan, &c, &pwm_hw->slice[slice_num].cc, lut,
+                        transfer_count, true);
+}
+
+// Play the current effect, or the indicator that overrides it
+static void apply() {
+  if (dma_chan < 0)
+    return;
+
+  l84_led_effect_t e = caps_lock ? L84_LED_EFFECT_SOLID : effect;
+
+  switch (e) {
+  case L84_LED_EFFECT_SOLID:
+    play(solid_lut, CONSTANT_RING_BITS);
+    break;
+  case L84_LED_EFFECT_BREATHE:
+    play(breathe_lut, BREATHE_RING_BITS);
+    break;
+  case L84_LED_EFFECT_OFF:
+  default:
+    play(off_lut, CONSTANT_RING_BITS);
+    break;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_led_init() {
+  fill_breathe_lut();
+
+  gpio_init(LED_PIN);
+  gpio_set_function(LED_PIN, GPIO_FUNC_PWM);
+  slice_num = pwm_gpio_to_slice_num(LED_PIN);
+
+  pwm_config config = pwm_get_default_config();
+  // Set divider so that the counter wraps LED_FRAME_HZ times per second
+  pwm_config_set_clkdiv(&config, pwm_clkdiv());
+  pwm_config_set_wrap(&config, LED_PWM_TOP);
+  // Load the configuration into our PWM slice, and set it running.
+  pwm_init(slice_num, &config, true);
+
+  dma_chan = dma_claim_unused_channel(true);
+  apply();
+}
+
+void l84_led_on_clock_change() {
+  if (dma_chan < 0)
+    return;
+  pwm_set_clkdiv(slice_num, pwm_clkdiv());
+}
+
+void l84_led_set_effect(l84_led_effect_t new_effect) {
+  if (new_effect == effect)
+    return;
+  effect = new_effect;
+  apply();
+}
+
+void l84_led_set_caps_lock(bool on) {
+  if (on == caps_lock)
+    return;
+  caps_lock = on;
+  apply();
+}
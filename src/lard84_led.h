@@ -0,0 +1,43 @@
+/*
+** file: lard84_led.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** LED effects, rendered ahead of time into gamma-corrected lookup tables
+** and streamed to the PWM compare register by DMA, one entry per PWM
+** period. Once an effect is started, it costs no CPU time.
+*/
+
+#ifndef _LARD84_LED_H
+#define _LARD84_LED_H
+
+#include "lard84_board.h"
+#include "pico/types.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// See boards/*.json
+#define LED_PIN L84_BOARD_LED_PIN
+
+typedef enum {
+  L84_LED_EFFECT_OFF,
+  // Constant, full brightness
+  L84_LED_EFFECT_SOLID,
+  // Slow fade in and out
+  L84_LED_EFFECT_BREATHE,
+} l84_led_effect_t;
+
+// Setup the PWM slice of LED_PIN and the DMA channel feeding it, and start
+// the idle effect
+void l84_led_init();
+// Switch to another effect. Indicators set by the host take precedence.
+void l84_led_set_effect(l84_led_effect_t effect);
+// Re-derive the PWM divider after clk_sys changed, so that effects keep
+// their speed
+void l84_led_on_clock_change();
+// Caps lock state as reported by the host: the LED is solid while it is on
+void l84_led_set_caps_lock(bool on);
+
+#endif /* _LARD84_LED_H */
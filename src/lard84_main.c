@@ -6,11 +6,25 @@
 
 #include "class/hid/hid.h"
 #include "class/hid/hid_device.h"
+#include "lard84_boot.h"
+#include "lard84_clock.h"
+#include "lard84_combo.h"
+#include "lard84_cycles.h"
+#include "lard84_flash.h"
+#include "lard84_hid.h"
 #include "lard84_keycodes.h"
 #include "lard84_keymatrix.h"
+#include "lard84_keyorder.h"
+#include "lard84_keystats.h"
+#include "lard84_led.h"
+#include "lard84_report.h"
+#include "lard84_socd.h"
+#include "lard84_stack.h"
+#include "lard84_update.h"
 #include "tusb_config.h"
 #include <hardware/gpio.h>
-#include <hardware/pwm.h>
+#include <hardware/structs/scb.h>
+#include <hardware/sync.h>
 #include <hardware/structs/io_bank0.h>
 #include <pico/multicore.h>
 #include <pico/mutex.h>
@@ -21,46 +35,10 @@
 #include <stdio.h> // printf via uart
 #include <tusb.h>
 
-const uint LED_PIN = 4;
-
-void led_fade_init() {
-  gpio_init(LED_PIN);
-  gpio_set_function(LED_PIN, GPIO_FUNC_PWM);
-  // gpio_set_dir(LED_PIN, GPIO_OUT);
-  uint slice_num = pwm_gpio_to_slice_num(LED_PIN);
-  pwm_config config = pwm_get_default_config();
-  // Set divider, reduces counter clock to sysclock/this value
-  pwm_config_set_clkdiv(&config, 4.f);
-  // Load the configuration into our PWM slice, and set it running.
-  pwm_init(slice_num, &config, true);
-  pwm_set_wrap(slice_num, 512);
-  // pwm_set_chan_level(slice_num, PWM_CHAN_A, 1);
-  // pwm_set_chan_level(slice_num, PWM_CHAN_B, 3);
-  pwm_set_enabled(slice_num, true);
-}
-
-void led_fade_task() {
-  static absolute_time_t next_call_time = 0;
-  absolute_time_t now = get_absolute_time();
-  static int led_intensity = 0;
-  static int fade_up = 1;
-
-  int64_t delta_t = absolute_time_diff_us(now, next_call_time);
-
-  if (delta_t < 0) {
-
-    pwm_set_gpio_level(LED_PIN, led_intensity);
-    led_intensity += 1 * fade_up;
-    if (led_intensity > 64) {
-      fade_up = -1;
-    } else if (led_intensity <= 0) {
-      fade_up = 1;
-    }
-    // printf("intensity: %d, fade %d\n", led_intensity, fade_up);
-
-    next_call_time = delayed_by_ms(now, 8);
-  }
-}
+// Set by core1 when the held keys changed, cleared by core0 once it has
+// picked up the change. Core1 also sends an event to wake core0 up.
+static volatile bool report_ready = false;
+static volatile uint32_t report_ready_us = 0;
 
 void polling_task(mutex_t *mutex) {
   static absolute_time_t next_call_time = 0;
@@ -71,8 +49,22 @@ void polling_task(mutex_t *mutex) {
   if (delta_t < 0) {
     absolute_time_t poll_start = get_absolute_time();
 
+    static uint32_t last_generation = 0;
+
     l84_keymatrix_poll(mutex);
 
+    // Only this core modifies the key order list, no need for the mutex
+    uint32_t generation = l84_keyorder_generation();
+    if (generation != last_generation) {
+      last_generation = generation;
+      if (!report_ready) {
+        report_ready_us = time_us_32();
+        __dmb();
+        report_ready = true;
+      }
+      __sev();
+    }
+
     absolute_time_t poll_done = get_absolute_time();
     int64_t poll_time_us = absolute_time_diff_us(poll_start, poll_done);
 
@@ -84,54 +76,104 @@ void polling_task(mutex_t *mutex) {
   }
 }
 
-void hid_task(mutex_t *mutex) {
-  // Aim to send a HID report every 1ms
-  static absolute_time_t next_call_time = 0;
-  static absolute_time_t last_call_time = 0;
-  absolute_time_t now = get_absolute_time();
+// Time from core1 signalling a change to the report being handed to the
+// USB stack (IN endpoint armed), in microseconds
+static uint32_t report_latency_max_us = 0;
+static uint64_t report_latency_sum_us = 0;
+static uint32_t report_latency_count = 0;
 
-  int64_t delta_t = absolute_time_diff_us(now, next_call_time);
-  if (delta_t < 0) {
-    // printf("Time to send HID\n");
-    if (!tud_hid_ready()) {
-      // printf("tud_hid_ready is FALSE\n");
-      return;
+void hid_task(mutex_t *mutex) {
+  // Reports are built when core1 signals a change, and sent as soon as the
+  // endpoint is free. Retries happen when the previous transfer completes,
+  // which wakes this core up through the USB interrupt.
+  static bool latency_armed = false;
+  static uint32_t latency_start_us = 0;
+
+  if (report_ready) {
+    // Changes before enumeration wait for the host, not for this core
+    if (!latency_armed && tud_mounted()) {
+      latency_armed = true;
+      latency_start_us = report_ready_us;
     }
-    last_call_time = get_absolute_time();
+    report_ready = false;
+    __dmb();
 
-    uint8_t keycode[6] = {0};
+    l84_clock_note_activity(time_us_32());
 
+    l84_report_t report;
+
+    // Keys are listed in the order they were pressed, see lard84_report.c
     mutex_enter_blocking(mutex);
-    uint keypressed_idx = 0;
-    for (uint col = 0; col < N_COLS; ++col) {
-      for (uint row = 0; row < N_ROWS; ++row) {
-        if (l84_keymatrix_is_key_pressed(col, row)) {
-          keycode[keypressed_idx++] =
-              l84_keycode_get(col, row, l84_keymatrix_is_fn_key_pressed());
-          if (keypressed_idx > 5) {
-            break;
-          }
-        }
-      }
-    }
+    bool fn = l84_keymatrix_is_fn_key_pressed();
+    l84_report_build(&report, fn);
+    // Keys held back by the combos are held too
+    bool keys_held = fn || l84_keyorder_count() != 0 || l84_combo_is_waiting();
     mutex_exit(mutex);
 
-    tud_hid_keyboard_report(0, 0, keycode);
+    l84_update_note_activity(time_us_32(), keys_held);
 
-    next_call_time = delayed_by_ms(get_absolute_time(), 1);
+    // Only reports that changed are sent, keyboard first
+    l84_hid_update(&report, time_us_32());
   }
+
+  bool sent = l84_hid_send_next(time_us_32());
+  if (sent)
+    l84_boot_mark(L84_BOOT_FIRST_REPORT);
+
+  if (sent && latency_armed) {
+    uint32_t latency_us = time_us_32() - latency_start_us;
+    if (latency_us > report_latency_max_us)
+      report_latency_max_us = latency_us;
+    report_latency_sum_us += latency_us;
+    report_latency_count++;
+    latency_armed = false;
+  }
+
+  // The change did not affect any report (e.g. a combo key held back)
+  if (latency_armed && !l84_hid_pending())
+    latency_armed = false;
 }
 
 static mutex_t keymatrix_mutex;
 
+// Earliest of wakeup and a task deadline given as a time_us_32() value
+static absolute_time_t earliest_wakeup(absolute_time_t wakeup,
+                                       uint32_t task_wakeup_us) {
+  int32_t in_us = (int32_t)(task_wakeup_us - time_us_32());
+  absolute_time_t task_wakeup =
+      delayed_by_us(get_absolute_time(), in_us > 0 ? (uint64_t)in_us : 0);
+  return absolute_time_diff_us(task_wakeup, wakeup) > 0 ? task_wakeup : wakeup;
+}
+
+// Loop times of each core, for the average printed every 500ms. Kept off the
+// stacks, see lard84_stack.h.
+#define LOOP_TIME_WINDOW_SIZE 256
+static uint32_t core0_loop_time_window[LOOP_TIME_WINDOW_SIZE] = {0};
+static uint32_t core1_loop_time_window[LOOP_TIME_WINDOW_SIZE] = {0};
+
+static uint32_t loop_time_avg(const uint32_t *window) {
+  uint64_t sum = 0;
+  for (uint i = 0; i < LOOP_TIME_WINDOW_SIZE; ++i) {
+    sum += window[i];
+  }
+  return (uint32_t)(sum / LOOP_TIME_WINDOW_SIZE);
+}
+
 void core1_main() {
   /// Core 1 will poll the keymatrix and update the
   /// keyboard's state for core 0 to report via usb.
+  /// The LED runs on its own, see lard84_led.c
+
+  // Let core0 pause this core while it writes to flash
+  l84_flash_core1_init();
+  // For measuring the cost of the key statistics
+  l84_cycles_init();
 
-  led_fade_init();
+  // Scanning starts while core0 brings up USB, so that keys held at power up
+  // are debounced by the time the host configures the device
+  l84_keymatrix_setup();
+  l84_boot_mark(L84_BOOT_GPIO_SETUP);
 
-  const uint window_size = 256;
-  int64_t loop_time_window[window_size];
   uint16_t cycle_idx = 0;
 
   absolute_time_t last_print = 0;
@@ -139,45 +181,69 @@ void core1_main() {
   while (true) {
     absolute_time_t loop_start = get_absolute_time();
 
-    led_fade_task();
     polling_task(&keymatrix_mutex);
 
     absolute_time_t loop_done = get_absolute_time();
 
     int64_t loop_time_us = absolute_time_diff_us(loop_start, loop_done);
 
-    loop_time_window[cycle_idx % window_size] = loop_time_us;
-    double avg = 0.0;
-    for (uint i = 0; i < window_size; ++i) {
-      avg += (double)(loop_time_window[i]) / window_size;
-    }
+    core1_loop_time_window[cycle_idx % LOOP_TIME_WINDOW_SIZE] = loop_time_us;
     cycle_idx++;
 
     if (absolute_time_diff_us(last_print, loop_done) > 500000) {
-      printf("Core1 loop time: %lldus (avg %lldus)\n", loop_time_us,
-             (int64_t)avg);
+      // Only average the window when printing, like core0
+      printf("Core1 loop time: %lldus (avg %luus)\n", loop_time_us,
+             (unsigned long)loop_time_avg(core1_loop_time_window));
       last_print = loop_done;
     }
   }
 }
 
 int main() {
+  // Before anything else uses the stack
+  l84_stack_paint_core0();
+  l84_boot_mark(L84_BOOT_MAIN);
+
   stdio_init_all();
+  l84_boot_mark(L84_BOOT_STDIO);
 
+  // Only what core1 needs before its first scan, see lard84_boot.h for the
+  // phases
   mutex_init(&keymatrix_mutex);
-  l84_keymatrix_setup();
+  l84_socd_set_default_pairs();
+  l84_combo_load(l84_default_combos, l84_num_default_combos);
+  // Reads the partition table through the bootrom, before core1 runs
+  l84_update_init();
 
-  multicore_launch_core1(core1_main);
+  l84_stack_launch_core1(core1_main);
+  l84_boot_mark(L84_BOOT_CORE1_LAUNCH);
 
+  // Enumeration starts as soon as the device connects to the bus, while
+  // core1 sets up the matrix
   tud_init(BOARD_TUD_RHPORT);
+  l84_boot_mark(L84_BOOT_USB_INIT);
+
+  // Not needed for the first report
+  l84_led_init();
+  l84_keystats_init();
+  l84_boot_init();
+  l84_stack_init();
+
+  // Wake up from WFE on any interrupt becoming pending, even if it was
+  // already serviced before reaching WFE, so that no USB event is missed
+  scb_hw->scr |= M33_SCR_SEVONPEND_BITS;
 
-  const uint window_size = 256;
-  int64_t loop_time_window[window_size];
   uint16_t cycle_idx = 0;
 
   int64_t max_loop_time = 0;
 
   absolute_time_t last_print = 0;
+  absolute_time_t last_stats_print = 0;
+
+  // Time spent awake vs. asleep in WFE since the last print
+  uint64_t awake_us = 0;
+  uint64_t asleep_us = 0;
+  uint32_t wake_count = 0;
 
   while (true) {
     absolute_time_t loop_start = get_absolute_time();
@@ -186,20 +252,64 @@ int main() {
 
     hid_task(&keymatrix_mutex);
 
+    // After the report went out, so that raising the clock does not delay it
+    l84_clock_task(time_us_32());
+
+    // Flash writes only happen after a long idle period
+    l84_keystats_task(&keymatrix_mutex, get_absolute_time());
+
+    // One flash operation at most per call, spaced out for core1
+    l84_update_task(time_us_32());
+
     absolute_time_t loop_done = get_absolute_time();
     int64_t loop_time_us = absolute_time_diff_us(loop_start, loop_done);
+    awake_us += loop_time_us;
 
-    loop_time_window[cycle_idx % window_size] = loop_time_us;
-    double avg = 0.0;
-    for (uint i = 0; i < window_size; ++i) {
-      avg += (double)(loop_time_window[i]) / window_size;
-    }
+    core0_loop_time_window[cycle_idx % LOOP_TIME_WINDOW_SIZE] = loop_time_us;
     cycle_idx++;
 
     if (absolute_time_diff_us(last_print, loop_done) > 500000) {
-      printf("Core0 loop time: %lldus (avg %lldus)\n", loop_time_us,
-             (int64_t)avg);
+      // Only average the window when printing, this loop runs on every wake
+      printf("Core0 loop time: %lldus (avg %luus)\n", loop_time_us,
+             (unsigned long)loop_time_avg(core0_loop_time_window));
+      printf("Core0 duty cycle: %llu%% (%lu wakes), report latency max %luus "
+             "(avg %luus)\n",
+             (100 * awake_us) / (awake_us + asleep_us + 1),
+             (unsigned long)wake_count, (unsigned long)report_latency_max_us,
+             (unsigned long)(report_latency_count
+                                 ? report_latency_sum_us / report_latency_count
+                                 : 0));
+      awake_us = asleep_us = 0;
+      wake_count = 0;
       last_print = loop_done;
     }
+
+    if (absolute_time_diff_us(last_stats_print, loop_done) > 10000000) {
+      l84_hid_print_stats();
+      l84_clock_print_stats();
+      l84_keystats_print_stats();
+      l84_boot_print_stats();
+      l84_stack_print_stats();
+      l84_update_print_stats();
+      last_stats_print = loop_done;
+    }
+
+    // Sleep until the USB interrupt, core1 signalling a change, or the next
+    // deadline (mouse keys, firmware update, clock switch, prints)
+    if (!tud_task_event_ready() && !report_ready) {
+      absolute_time_t wakeup = delayed_by_us(last_print, 500000);
+      uint32_t task_wakeup_us;
+      if (l84_hid_next_wakeup(&task_wakeup_us))
+        wakeup = earliest_wakeup(wakeup, task_wakeup_us);
+      if (l84_update_next_wakeup(&task_wakeup_us))
+        wakeup = earliest_wakeup(wakeup, task_wakeup_us);
+      if (l84_clock_next_wakeup(&task_wakeup_us))
+        wakeup = earliest_wakeup(wakeup, task_wakeup_us);
+
+      absolute_time_t sleep_start = get_absolute_time();
+      best_effort_wfe_or_timeout(wakeup);
+      asleep_us += absolute_time_diff_us(sleep_start, get_absolute_time());
+      wake_count++;
+    }
   }
 }
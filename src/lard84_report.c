@@ -0,0 +1,106 @@
+/*
+** file: lard84_report.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Build HID reports from the held keys, in press order.
+** Keyboard usages go to the 6 keycode slots, consumer/system/mouse usages
+** (see L84_KC_* in lard84_keycodes.h) to their own reports.
+*/
+
+#include "lard84_report.h"
+
+#include "lard84_combo.h"
+#include "lard84_keycodes.h"
+#include "lard84_keyorder.h"
+#include "lard84_socd.h"
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+static l84_rollover_policy_t rollover_policy = L84_ROLLOVER_DEFAULT;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+// Keycode of a matrix key or of a virtual key
+static uint32_t resolve_keycode(uint8_t key, bool fn_layer) {
+  if (key >= N_KEYS)
+    return l84_combo_keycode(key - N_KEYS);
+  return l84_keycode_get(L84_KEY_COL(key), L84_KEY_ROW(key), fn_layer);
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_report_set_rollover_policy(l84_rollover_policy_t policy) {
+  rollover_policy = policy;
+}
+
+l84_rollover_policy_t l84_report_get_rollover_policy() {
+  return rollover_policy;
+}
+
+void l84_report_build(l84_report_t *report, bool fn_layer) {
+  const l84_keyorder_entry_t *entries = l84_keyorder_entries();
+  const uint8_t count = l84_keyorder_count();
+
+  // Keys that survive SOCD resolution
+  l84_keymask_t active = *l84_keyorder_mask();
+  l84_socd_resolve(&active);
+
+  memset(report, 0, sizeof(*report));
+
+  // Keyboard usages, in press order. With L84_ROLLOVER_LAST_PRESSED, kept
+  // is used as a ring buffer holding the last L84_REPORT_N_KEYCODES of them.
+  uint8_t kept[L84_REPORT_N_KEYCODES];
+  uint8_t n_keyboard = 0;
+
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t key = entries[i].key;
+    if (!l84_keymask_test(&active, key))
+      continue;
+
+    uint32_t kc = resolve_keycode(key, fn_layer);
+    if (!kc)
+      continue;
+
+    switch (L84_KC_TYPE(kc)) {
+    case L84_KC_TYPE_KEYBOARD:
+      if (rollover_policy == L84_ROLLOVER_FIRST_PRESSED) {
+        if (n_keyboard < L84_REPORT_N_KEYCODES)
+          kept[n_keyboard++] = (uint8_t)kc;
+      } else {
+        kept[n_keyboard++ % L84_REPORT_N_KEYCODES] = (uint8_t)kc;
+      }
+      break;
+    // Consumer and system reports hold a single usage: the last press wins
+    case L84_KC_TYPE_CONSUMER:
+      report->consumer = L84_KC_USAGE(kc);
+      break;
+    case L84_KC_TYPE_SYSTEM:
+      report->system = L84_KC_USAGE(kc);
+      break;
+    case L84_KC_TYPE_MOUSE:
+      report->mouse_buttons |= L84_KC_USAGE(kc) & 0xff;
+      report->mouse_motion |= L84_KC_USAGE(kc) >> 8;
+      break;
+    default:
+      break;
+    }
+  }
+
+  if (n_keyboard <= L84_REPORT_N_KEYCODES) {
+    memcpy(report->keycode, kept, n_keyboard);
+  } else {
+    // The ring wrapped: the oldest kept key is right after the newest one
+    uint8_t oldest = n_keyboard % L84_REPORT_N_KEYCODES;
+    for (uint8_t i = 0; i < L84_REPORT_N_KEYCODES; ++i) {
+      report->keycode[i] = kept[(oldest + i) % L84_REPORT_N_KEYCODES];
+    }
+  }
+}
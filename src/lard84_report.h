@@ -0,0 +1,54 @@
+/*
+** file: lard84_report.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Build HID reports from the held keys, in press order.
+*/
+
+#ifndef _LARD84_REPORT_H
+#define _LARD84_REPORT_H
+
+#include "lard84_keymask.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Number of keycode slots in a boot keyboard report
+#define L84_REPORT_N_KEYCODES 6
+
+// Which keys are kept when more keys are held than there are slots
+typedef enum {
+  // The keys pressed first stay in the report, later presses are dropped
+  L84_ROLLOVER_FIRST_PRESSED,
+  // The most recent presses stay in the report, the oldest are evicted
+  L84_ROLLOVER_LAST_PRESSED,
+} l84_rollover_policy_t;
+
+#ifndef L84_ROLLOVER_DEFAULT
+#define L84_ROLLOVER_DEFAULT L84_ROLLOVER_FIRST_PRESSED
+#endif
+
+void l84_report_set_rollover_policy(l84_rollover_policy_t policy);
+l84_rollover_policy_t l84_report_get_rollover_policy();
+
+// Content of all HID input reports, as built from the held keys
+typedef struct {
+  // Keyboard usages, in the order they were pressed, zero padded
+  uint8_t keycode[L84_REPORT_N_KEYCODES];
+  // Consumer control usage (media keys), 0 if none
+  uint16_t consumer;
+  // Generic desktop system control usage (power/sleep/wake), 0 if none
+  uint16_t system;
+  // Mouse buttons held, L84_MOUSE_BUTTON_* bits
+  uint8_t mouse_buttons;
+  // Mouse directions held, L84_MOUSE_MOTION_* bits
+  uint8_t mouse_motion;
+} l84_report_t;
+
+// Fill report from the held keys, after SOCD resolution (see lard84_socd.h).
+// Keymatrix mutex should be held while calling this.
+void l84_report_build(l84_report_t *report, bool fn_layer);
+
+#endif /* _LARD84_REPORT_H */
@@ -0,0 +1,111 @@
+/*
+** file: lard84_socd.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Simultaneous opposing cardinal directions (SOCD) resolution.
+*/
+
+#include "lard84_socd.h"
+
+#include "lard84_keyorder.h"
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+typedef struct {
+  uint8_t key_a;
+  uint8_t key_b;
+} socd_pair_t;
+
+static l84_socd_mode_t mode = L84_SOCD_DEFAULT_MODE;
+
+static socd_pair_t pairs[L84_SOCD_MAX_PAIRS];
+static uint8_t num_pairs = 0;
+
+// Keys that already belong to a pair
+static l84_keymask_t paired_keys = {0};
+
+// Default pairs, as (col, row) positions in the key matrix
+// Arrow cluster: left/right and up/down
+// WASD: A/D and W/S
+static const uint8_t default_pairs[][2] = {
+    {L84_KEY_INDEX(13, 5), L84_KEY_INDEX(15, 5)}, // left, right
+    {L84_KEY_INDEX(14, 4), L84_KEY_INDEX(14, 5)}, // up, down
+    {L84_KEY_INDEX(1, 3), L84_KEY_INDEX(3, 3)},   // A, D
+    {L84_KEY_INDEX(2, 2), L84_KEY_INDEX(2, 3)},   // W, S
+};
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_socd_set_mode(l84_socd_mode_t new_mode) { mode = new_mode; }
+
+l84_socd_mode_t l84_socd_get_mode() { return mode; }
+
+void l84_socd_clear_pairs() {
+  num_pairs = 0;
+  memset(&paired_keys, 0, sizeof(paired_keys));
+}
+
+bool l84_socd_add_pair(uint8_t key_a, uint8_t key_b) {
+  if (num_pairs >= L84_SOCD_MAX_PAIRS)
+    return false;
+  if (key_a >= N_KEYS || key_b >= N_KEYS || key_a == key_b)
+    return false;
+  if (l84_keymask_test(&paired_keys, key_a) ||
+      l84_keymask_test(&paired_keys, key_b))
+    return false;
+
+  pairs[num_pairs].key_a = key_a;
+  pairs[num_pairs].key_b = key_b;
+  num_pairs++;
+  l84_keymask_set(&paired_keys, key_a);
+  l84_keymask_set(&paired_keys, key_b);
+  return true;
+}
+
+void l84_socd_set_default_pairs() {
+  l84_socd_clear_pairs();
+  for (size_t i = 0; i < sizeof(default_pairs) / sizeof(default_pairs[0]);
+       ++i) {
+    l84_socd_add_pair(default_pairs[i][0], default_pairs[i][1]);
+  }
+}
+
+void l84_socd_resolve(l84_keymask_t *held) {
+  if (mode == L84_SOCD_OFF)
+    return;
+
+  for (uint8_t i = 0; i < num_pairs; ++i) {
+    const uint8_t a = pairs[i].key_a;
+    const uint8_t b = pairs[i].key_b;
+
+    if (!l84_keymask_test(held, a) || !l84_keymask_test(held, b))
+      continue;
+
+    // Both held: the winner is decided by which one was pressed last.
+    // Going from one direction to the other is a single report, since the
+    // losing key disappears in the same report the winning key appears.
+    const bool b_is_last =
+        l84_keyorder_press_seq(b) > l84_keyorder_press_seq(a);
+
+    switch (mode) {
+    case L84_SOCD_LAST_INPUT:
+      l84_keymask_clear(held, b_is_last ? a : b);
+      break;
+    case L84_SOCD_FIRST_INPUT:
+      l84_keymask_clear(held, b_is_last ? b : a);
+      break;
+    case L84_SOCD_NEUTRAL:
+      l84_keymask_clear(held, a);
+      l84_keymask_clear(held, b);
+      break;
+    default:
+      break;
+    }
+  }
+}
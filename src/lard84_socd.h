@@ -0,0 +1,57 @@
+/*
+** file: lard84_socd.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Simultaneous opposing cardinal directions (SOCD) resolution.
+** When both keys of an opposing pair (e.g. left/right) are held, only one
+** of them, or neither, is sent to the host.
+*/
+
+#ifndef _LARD84_SOCD_H
+#define _LARD84_SOCD_H
+
+#include "lard84_keymask.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+typedef enum {
+  // Both keys are reported, as without SOCD resolution
+  L84_SOCD_OFF,
+  // The key pressed last wins (a.k.a. snap tap)
+  L84_SOCD_LAST_INPUT,
+  // Neither key is reported while both are held
+  L84_SOCD_NEUTRAL,
+  // The key pressed first wins
+  L84_SOCD_FIRST_INPUT,
+} l84_socd_mode_t;
+
+// Maximum number of opposing key pairs
+#define L84_SOCD_MAX_PAIRS 8
+
+// Off by default: resolving pairs while typing drops and repeats letters
+// (e.g. typing "ad" quickly on a WASD pair). Firmware builds set it from
+// LARD84_SOCD_MODE.
+#ifndef L84_SOCD_DEFAULT_MODE
+#define L84_SOCD_DEFAULT_MODE L84_SOCD_OFF
+#endif
+
+void l84_socd_set_mode(l84_socd_mode_t mode);
+l84_socd_mode_t l84_socd_get_mode();
+
+// Remove all pairs
+void l84_socd_clear_pairs();
+// Add an opposing pair of keys, by flat key index. A key can only belong to
+// one pair. Returns false if the pair could not be added.
+bool l84_socd_add_pair(uint8_t key_a, uint8_t key_b);
+// Restore the default pairs: arrow cluster and WASD
+void l84_socd_set_default_pairs();
+
+// Remove the losing keys of every pair from held, given the press order
+// recorded in lard84_keyorder. Runs in time proportional to the number of
+// pairs, independent of the number of held keys.
+void l84_socd_resolve(l84_keymask_t *held);
+
+#endif /* _LARD84_SOCD_H */
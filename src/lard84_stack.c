@@ -0,0 +1,108 @@
+/*
+** file: lard84_stack.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Stack high-water marks of both cores.
+*/
+
+#include "lard84_stack.h"
+
+#include "lard84_diag.h"
+#include "pico/multicore.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+#define STACK_PAINT 0xdeadbeefu
+
+// Words just below the current stack pointer that are left alone when
+// painting the live core0 stack
+#define CORE0_PAINT_MARGIN 16
+
+// Core0 stack, from the linker script (SCRATCH_Y)
+extern uint32_t __StackBottom[];
+extern uint32_t __StackTop[];
+// Core1 stack, reserved by pico_multicore (.stack1 in SCRATCH_X)
+extern uint32_t __StackOneBottom[];
+extern uint32_t __StackOneTop[];
+
+// Diagnostics topic: size and used bytes for core0, then core1, as 32 bit
+// values
+#define TOPIC_SIZE (2 * sizeof(l84_stack_usage_t))
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static uint32_t *current_sp() {
+  uint32_t *sp;
+  __asm volatile("mov %0, sp" : "=r"(sp));
+  return sp;
+}
+
+static void paint(uint32_t *bottom, uint32_t *end) {
+  for (uint32_t *p = bottom; p < end; ++p) {
+    *p = STACK_PAINT;
+  }
+}
+
+// Stacks grow down: the first word from the bottom that lost the pattern is
+// the deepest point reached
+static uint32_t used_bytes(const uint32_t *bottom, const uint32_t *top) {
+  const uint32_t *p = bottom;
+  while (p < top && *p == STACK_PAINT) {
+    ++p;
+  }
+  return (uint32_t)(top - p) * sizeof(uint32_t);
+}
+
+static uint16_t topic_size() { return TOPIC_SIZE; }
+
+static void topic_read(uint16_t offset, uint8_t *buf, uint16_t len) {
+  l84_stack_usage_t usage[2];
+  l84_stack_usage(0, &usage[0]);
+  l84_stack_usage(1, &usage[1]);
+  const uint8_t *bytes = (const uint8_t *)usage;
+  for (uint16_t i = 0; i < len; ++i) {
+    buf[i] = bytes[offset + i];
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_stack_paint_core0() {
+  paint(__StackBottom, current_sp() - CORE0_PAINT_MARGIN);
+}
+
+void l84_stack_launch_core1(void (*entry)()) {
+  paint(__StackOneBottom, __StackOneTop);
+  multicore_launch_core1(entry);
+}
+
+void l84_stack_usage(uint core, l84_stack_usage_t *usage) {
+  const uint32_t *bottom = core ? __StackOneBottom : __StackBottom;
+  const uint32_t *top = core ? __StackOneTop : __StackTop;
+  usage->size = (uint32_t)(top - bottom) * sizeof(uint32_t);
+  usage->used = used_bytes(bottom, top);
+}
+
+void l84_stack_init() {
+  l84_diag_register(L84_DIAG_TOPIC_STACK, topic_size, topic_read);
+}
+
+void l84_stack_print_stats() {
+  printf("Stacks:");
+  for (uint core = 0; core < 2; ++core) {
+    l84_stack_usage_t usage;
+    l84_stack_usage(core, &usage);
+    printf(" core%u %lu/%luB%s", core, (unsigned long)usage.used,
+           (unsigned long)usage.size,
+           usage.size - usage.used < L84_STACK_MIN_FREE ? " (LOW)" : "");
+  }
+  printf("\n");
+}
@@ -0,0 +1,42 @@
+/*
+** file: lard84_stack.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Stack high-water marks of both cores.
+** Stacks are filled with a known pattern before use; the deepest word that
+** no longer holds the pattern is the most the stack was ever used.
+** Core1 runs on the SDK's stack in SCRATCH_X, of PICO_CORE1_STACK_SIZE bytes
+** (set from LARD84_CORE1_STACK_SIZE in CMake). The usage can be read from the
+** host as the L84_DIAG_TOPIC_STACK diagnostics topic.
+*/
+
+#ifndef _LARD84_STACK_H
+#define _LARD84_STACK_H
+
+#include "pico/types.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Stacks with less than this many bytes left are reported as at risk
+#define L84_STACK_MIN_FREE 256
+
+typedef struct {
+  uint32_t size;
+  uint32_t used;
+} l84_stack_usage_t;
+
+// Paint the unused part of the core0 stack. Call first thing in main.
+void l84_stack_paint_core0();
+// Paint the core1 stack and launch core1, like multicore_launch_core1
+void l84_stack_launch_core1(void (*entry)());
+// Deepest stack usage so far, core is 0 or 1
+void l84_stack_usage(uint core, l84_stack_usage_t *usage);
+// Register the diagnostics topic
+void l84_stack_init();
+// Print the usage of both stacks
+void l84_stack_print_stats();
+
+#endif /* _LARD84_STACK_H */
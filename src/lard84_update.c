@@ -0,0 +1,429 @@
+/*
+** file: lard84_update.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Firmware update over USB, into the inactive A/B partition.
+**
+** Received data goes through a staging buffer of two flash sectors: the host
+** fills one while the other is written. A sector is written with one erase,
+** then one program per flash page, each in its own task call.
+*/
+
+#include "lard84_update.h"
+
+#include "boot/picobin.h"
+#include "hardware/regs/addressmap.h"
+#include "lard84_clock.h"
+#include "lard84_flash.h"
+#include "lard84_keystats.h"
+#include "pico/bootrom.h"
+#include "pico/sha256.h"
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+#define STAGING_SIZE (2 * FLASH_SECTOR_SIZE)
+#define NO_PARTITION 0xff
+#define HASH_SIZE 32
+// Failed flash operations are retried this many times before giving up
+#define MAX_FLASH_RETRIES 3
+// Lets the status report of the commit reach the host before the reboot
+#define REBOOT_DELAY_MS 100
+// Keeps the clock up while the image is being hashed
+#define HASH_BURST_US 10000
+
+// Received data, indexed by image offset modulo its size. Also the bootrom
+// work area while no update is in progress.
+static uint8_t staging[STAGING_SIZE] __attribute__((aligned(4)));
+
+static l84_update_state_t state = L84_UPDATE_IDLE;
+static l84_update_error_t error = L84_UPDATE_OK;
+
+// Partitions, as found by l84_update_init
+static uint8_t running_partition = NO_PARTITION;
+static uint8_t target_partition = NO_PARTITION;
+static uint32_t target_offset = 0;
+static uint32_t target_size = 0;
+
+// Update in progress
+static uint32_t image_size = 0;
+static uint8_t image_hash[HASH_SIZE];
+static uint32_t received = 0;
+// Always a multiple of FLASH_SECTOR_SIZE, until the whole image is written
+static uint32_t written = 0;
+// Progress within the sector at written
+static bool sector_erased = false;
+static uint32_t sector_programmed = 0;
+static uint8_t flash_retries = 0;
+
+static uint32_t last_op_us = 0;
+static uint32_t last_activity_us = 0;
+// Core1 does not scan during an erase: none start while keys are held, so
+// no release is missed, and keys pressed during one are seen after it
+static bool keys_held = false;
+static uint32_t erase_wait_start_us = 0;
+static bool erase_waiting = false;
+
+static pico_sha256_state_t sha_state;
+static bool hashing = false;
+static uint32_t hashed = 0;
+
+// Longest wait for a gap in typing before an erase, and number of flash
+// operations
+static uint32_t erase_wait_max_us = 0;
+static uint32_t num_flash_ops = 0;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static uint32_t get_u32(const uint8_t *buf) {
+  return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static void put_u32(uint8_t *buf, uint32_t value) {
+  buf[0] = value;
+  buf[1] = value >> 8;
+  buf[2] = value >> 16;
+  buf[3] = value >> 24;
+}
+
+static bool partition_location(uint partition, uint32_t *offset,
+                               uint32_t *size) {
+  uint32_t info[3];
+  int ret = rom_get_partition_table_info(
+      info, count_of(info),
+      PT_INFO_PARTITION_LOCATION_AND_FLAGS | PT_INFO_SINGLE_PARTITION |
+          (partition << 24));
+  if (ret != (int)count_of(info))
+    return false;
+
+  uint32_t first = (info[1] >> PICOBIN_PARTITION_LOCATION_FIRST_SECTOR_LSB) &
+                   PICOBIN_PARTITION_LOCATION_SECTOR_BITMASK;
+  uint32_t last = (info[1] >> PICOBIN_PARTITION_LOCATION_LAST_SECTOR_LSB) &
+                  PICOBIN_PARTITION_LOCATION_SECTOR_BITMASK;
+  *offset = first * FLASH_SECTOR_SIZE;
+  *size = (last + 1 - first) * FLASH_SECTOR_SIZE;
+  return true;
+}
+
+// The other partition of the A/B pair the running one belongs to
+static int other_partition(uint partition) {
+  int b = rom_get_b_partition(partition);
+  if (b >= 0)
+    return b;
+  for (uint a = 0; a < PARTITION_TABLE_MAX_PARTITIONS; ++a) {
+    if (rom_get_b_partition(a) == (int)partition)
+      return a;
+  }
+  return -1;
+}
+
+// Releases the SHA-256 hardware
+static void finish_hash(sha256_result_t *result) {
+  pico_sha256_finish(&sha_state, result);
+  hashing = false;
+}
+
+static void fail(l84_update_error_t err) {
+  if (hashing)
+    finish_hash(&(sha256_result_t){0});
+  state = L84_UPDATE_FAILED;
+  error = err;
+  printf("Update: failed (error %d)\n", err);
+}
+
+static void begin(uint32_t size, const uint8_t *hash) {
+  // Rebooting into the new image
+  if (state == L84_UPDATE_COMMITTED)
+    return;
+  if (state == L84_UPDATE_RECEIVING || state == L84_UPDATE_VERIFYING) {
+    fail(L84_UPDATE_ERR_STATE);
+    return;
+  }
+  if (target_partition == NO_PARTITION) {
+    fail(L84_UPDATE_ERR_NO_PARTITION);
+    return;
+  }
+  if (size == 0 || size > target_size) {
+    fail(L84_UPDATE_ERR_TOO_LARGE);
+    return;
+  }
+
+  image_size = size;
+  memcpy(image_hash, hash, HASH_SIZE);
+  received = written = 0;
+  sector_erased = false;
+  sector_programmed = 0;
+  flash_retries = 0;
+  erase_waiting = false;
+  state = L84_UPDATE_RECEIVING;
+  error = L84_UPDATE_OK;
+  printf("Update: receiving %lu bytes into partition %u\n",
+         (unsigned long)size, target_partition);
+}
+
+static void receive(uint32_t offset, const uint8_t *data, uint8_t len) {
+  // Out of order, or no room left: the host resends from received
+  if (state != L84_UPDATE_RECEIVING || offset != received ||
+      len > image_size - received || received + len > written + STAGING_SIZE)
+    return;
+
+  uint32_t at = received % STAGING_SIZE;
+  uint32_t first = len < STAGING_SIZE - at ? len : STAGING_SIZE - at;
+  memcpy(&staging[at], data, first);
+  memcpy(staging, data + first, len - first);
+  received += len;
+}
+
+static void commit() {
+  if (state == L84_UPDATE_COMMITTED)
+    return;
+  if (state != L84_UPDATE_READY) {
+    fail(L84_UPDATE_ERR_STATE);
+    return;
+  }
+  printf("Update: rebooting into partition %u\n", target_partition);
+  // Returns right away, the watchdog reboots after the delay
+  if (rom_reboot(REBOOT2_FLAG_REBOOT_TYPE_FLASH_UPDATE, REBOOT_DELAY_MS,
+                 XIP_BASE + target_offset, 0) != BOOTROM_OK) {
+    fail(L84_UPDATE_ERR_STATE);
+    return;
+  }
+  state = L84_UPDATE_COMMITTED;
+}
+
+static void abort_update() {
+  if (state == L84_UPDATE_COMMITTED)
+    return;
+  if (hashing)
+    finish_hash(&(sha256_result_t){0});
+  state = L84_UPDATE_IDLE;
+  error = L84_UPDATE_OK;
+}
+
+static void flash_op_done(bool ok, uint32_t now_us) {
+  last_op_us = now_us;
+  num_flash_ops++;
+  if (ok) {
+    flash_retries = 0;
+  } else if (++flash_retries > MAX_FLASH_RETRIES) {
+    fail(L84_UPDATE_ERR_FLASH);
+  }
+}
+
+// Image bytes in the sector at written
+static uint32_t sector_len() {
+  return image_size - written < FLASH_SECTOR_SIZE ? image_size - written
+                                                  : FLASH_SECTOR_SIZE;
+}
+
+// The sector at written is complete in the staging buffer
+static bool sector_ready() {
+  return state == L84_UPDATE_RECEIVING && received >= written + sector_len();
+}
+
+// One flash operation on the sector at written
+static void write_step(uint32_t now_us) {
+  if (!sector_ready())
+    return;
+  uint32_t len = sector_len();
+
+  uint8_t *sector = &staging[written % STAGING_SIZE];
+  uint32_t offset = target_offset + written;
+
+  if (!sector_erased) {
+    // Wait for a gap in typing with no key held, however long it takes
+    if (!erase_waiting) {
+      erase_waiting = true;
+      erase_wait_start_us = now_us;
+    }
+    if (keys_held || now_us - last_activity_us < L84_UPDATE_ERASE_IDLE_US)
+      return;
+    erase_waiting = false;
+    uint32_t waited_us = now_us - erase_wait_start_us;
+    if (waited_us > erase_wait_max_us)
+      erase_wait_max_us = waited_us;
+
+    // Pad the last page of the image
+    if (len < FLASH_SECTOR_SIZE)
+      memset(sector + len, 0xff, FLASH_SECTOR_SIZE - len);
+
+    bool ok = l84_flash_erase(offset, FLASH_SECTOR_SIZE);
+    sector_erased = ok;
+    flash_op_done(ok, now_us);
+    return;
+  }
+
+  bool ok = l84_flash_program(offset + sector_programmed,
+                              sector + sector_programmed, FLASH_PAGE_SIZE);
+  flash_op_done(ok, now_us);
+  if (!ok)
+    return;
+
+  sector_programmed += FLASH_PAGE_SIZE;
+  if (sector_programmed < len)
+    return;
+
+  // Sector done, its half of the staging buffer can take new data
+  written += len;
+  sector_erased = false;
+  sector_programmed = 0;
+
+  if (written == image_size) {
+    if (pico_sha256_try_start(&sha_state, SHA256_BIG_ENDIAN, false) !=
+        PICO_OK) {
+      fail(L84_UPDATE_ERR_STATE);
+      return;
+    }
+    hashing = true;
+    hashed = 0;
+    state = L84_UPDATE_VERIFYING;
+  }
+}
+
+// Hash the next chunk of the image, read back from flash
+static void verify_step(uint32_t now_us) {
+  l84_clock_request_burst(now_us, HASH_BURST_US);
+
+  uint32_t len = image_size - hashed < L84_UPDATE_HASH_CHUNK
+                     ? image_size - hashed
+                     : L84_UPDATE_HASH_CHUNK;
+  pico_sha256_update(&sha_state, l84_flash_read_ptr(target_offset + hashed),
+                     len);
+  hashed += len;
+  if (hashed < image_size)
+    return;
+
+  sha256_result_t result;
+  finish_hash(&result);
+  if (memcmp(result.bytes, image_hash, HASH_SIZE) != 0) {
+    fail(L84_UPDATE_ERR_HASH);
+    return;
+  }
+  state = L84_UPDATE_READY;
+  printf("Update: image verified, waiting for commit\n");
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+void l84_update_init() {
+  boot_info_t info;
+  if (!rom_get_boot_info(&info) || info.partition < 0) {
+    printf("Update: not booted from a partition, updates disabled\n");
+    return;
+  }
+  running_partition = info.partition;
+
+  int other = -1;
+  if (rom_load_partition_table(staging, sizeof(staging), false) == BOOTROM_OK)
+    other = other_partition(running_partition);
+
+  uint32_t offset, size;
+  if (other < 0 || !partition_location(other, &offset, &size)) {
+    printf("Update: no A/B partition for %u, updates disabled\n",
+           running_partition);
+    return;
+  }
+  // Never write over the key statistics log
+  if (offset + size > L84_KEYSTATS_FLASH_OFFSET) {
+    printf("Update: partition %d overlaps the keystats log\n", other);
+    return;
+  }
+  target_partition = other;
+  target_offset = offset;
+  target_size = size;
+}
+
+void l84_update_set_report(const uint8_t *buf, uint16_t len) {
+  if (len < L84_UPDATE_HEADER_SIZE)
+    return;
+  uint8_t payload_len = buf[1];
+  if (payload_len > len - L84_UPDATE_HEADER_SIZE)
+    return;
+  uint32_t arg = get_u32(&buf[2]);
+  const uint8_t *payload = &buf[L84_UPDATE_HEADER_SIZE];
+
+  switch (buf[0]) {
+  case L84_UPDATE_CMD_BEGIN:
+    if (payload_len == HASH_SIZE)
+      begin(arg, payload);
+    break;
+  case L84_UPDATE_CMD_DATA:
+    receive(arg, payload, payload_len);
+    break;
+  case L84_UPDATE_CMD_COMMIT:
+    commit();
+    break;
+  case L84_UPDATE_CMD_ABORT:
+    abort_update();
+    break;
+  }
+}
+
+uint16_t l84_update_get_report(uint8_t *buf, uint16_t reqlen) {
+  if (reqlen < L84_UPDATE_REPORT_SIZE)
+    return 0;
+
+  memset(buf, 0, L84_UPDATE_REPORT_SIZE);
+  buf[0] = state;
+  buf[1] = error;
+  buf[2] = running_partition;
+  buf[3] = target_partition;
+  put_u32(&buf[4], target_size);
+  put_u32(&buf[8], image_size);
+  put_u32(&buf[12], received);
+  put_u32(&buf[16], written);
+  return L84_UPDATE_REPORT_SIZE;
+}
+
+void l84_update_note_activity(uint32_t now_us, bool held) {
+  last_activity_us = now_us;
+  keys_held = held;
+}
+
+void l84_update_task(uint32_t now_us) {
+  if (now_us - last_op_us < L84_UPDATE_OP_INTERVAL_US)
+    return;
+
+  if (state == L84_UPDATE_RECEIVING)
+    write_step(now_us);
+  else if (state == L84_UPDATE_VERIFYING)
+    verify_step(now_us);
+}
+
+bool l84_update_next_wakeup(uint32_t *wakeup_us) {
+  // Otherwise waiting for the host, whose reports wake core0 up
+  if (state != L84_UPDATE_VERIFYING && !sector_ready())
+    return false;
+
+  *wakeup_us = last_op_us + L84_UPDATE_OP_INTERVAL_US;
+  if (state == L84_UPDATE_RECEIVING && !sector_erased && erase_waiting) {
+    // Waiting for the keys to be released, which wakes core0 up
+    if (keys_held)
+      return false;
+    // End of the gap in typing
+    uint32_t erase_us = last_activity_us + L84_UPDATE_ERASE_IDLE_US;
+    if ((int32_t)(erase_us - *wakeup_us) > 0)
+      *wakeup_us = erase_us;
+  }
+  return true;
+}
+
+void l84_update_print_stats() {
+  if (target_partition == NO_PARTITION)
+    return;
+  printf("Update: partition %u, target %u (%luKB), state %d, error %d, "
+         "%lu/%lu bytes written, %lu flash ops, erase wait max %lums\n",
+         running_partition, target_partition,
+         (unsigned long)(target_size / 1024), state, error,
+         (unsigned long)written, (unsigned long)image_size,
+         (unsigned long)num_flash_ops,
+         (unsigned long)(erase_wait_max_us / 1000));
+}
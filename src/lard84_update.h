@@ -0,0 +1,108 @@
+/*
+** file: lard84_update.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Firmware update over USB, into the inactive A/B partition.
+**
+** Flash holds a partition table (boards/partitions.json) with two firmware
+** partitions, A and B; the bootrom boots one of them. The host streams a new
+** image through a vendor-defined HID feature report (L84_REPORT_ID_UPDATE)
+** while the keyboard keeps working. Core0 writes it into the other partition
+** one flash operation at a time, each of which pauses core1, spaced by at
+** least L84_UPDATE_OP_INTERVAL_US. Sector erases, the longest operations,
+** wait for a gap in typing with no key held, for as long as it takes. Once
+** written, the image is read back and checked against the SHA-256 the host
+** announced. On commit, the bootrom reboots into the new partition
+** (FLASH_UPDATE boot); the running partition is left as is, so a bad or
+** interrupted update still boots the old image. On later resets, the bootrom
+** boots the partition holding the image with the higher version: each build
+** is stamped with one (LARD84_VERSION_MINOR in CMakeLists.txt), so an image
+** only stays in place if it was built after the running one.
+**
+** SET_REPORT layout (after the report ID):
+**   0: command, 1: payload length, 2-5: argument (LE), 6-: payload
+**   BEGIN: argument is the image size, payload its SHA-256
+**   DATA: argument is the offset of the payload in the image. Data must come
+**     in order; reports that do not continue at the received count, or that
+**     do not fit in the staging buffer, are dropped. The host resends from
+**     the received count given in the status.
+**   COMMIT: reboot into the new image, once verified
+**   ABORT: drop the update in progress
+**
+** GET_REPORT layout (after the report ID):
+**   0: state, 1: error, 2: running partition, 3: target partition
+**   (0xff: none), 4-7: target partition size, 8-11: image size,
+**   12-15: bytes received, 16-19: bytes written to flash (LE)
+**
+** See tools/lard84_update.py.
+*/
+
+#ifndef _LARD84_UPDATE_H
+#define _LARD84_UPDATE_H
+
+#include "pico/types.h"
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+// Size of the feature report, without the report ID
+#define L84_UPDATE_REPORT_SIZE 63
+#define L84_UPDATE_HEADER_SIZE 6
+#define L84_UPDATE_PAYLOAD_SIZE                                                \
+  (L84_UPDATE_REPORT_SIZE - L84_UPDATE_HEADER_SIZE)
+
+// Minimum time between two flash operations, during which core1 scans
+#define L84_UPDATE_OP_INTERVAL_US 2000
+// Time without key changes before a sector erase (tens of ms) may start
+#define L84_UPDATE_ERASE_IDLE_US 50000
+// Image bytes hashed per task call during verification
+#define L84_UPDATE_HASH_CHUNK 4096
+
+typedef enum {
+  L84_UPDATE_CMD_BEGIN = 1,
+  L84_UPDATE_CMD_DATA,
+  L84_UPDATE_CMD_COMMIT,
+  L84_UPDATE_CMD_ABORT,
+} l84_update_cmd_t;
+
+typedef enum {
+  L84_UPDATE_IDLE,
+  L84_UPDATE_RECEIVING,
+  L84_UPDATE_VERIFYING,
+  L84_UPDATE_READY,
+  L84_UPDATE_COMMITTED,
+  L84_UPDATE_FAILED,
+} l84_update_state_t;
+
+typedef enum {
+  L84_UPDATE_OK,
+  // Not booted from an A/B partition, see README
+  L84_UPDATE_ERR_NO_PARTITION,
+  L84_UPDATE_ERR_TOO_LARGE,
+  L84_UPDATE_ERR_FLASH,
+  L84_UPDATE_ERR_HASH,
+  // Command not valid in the current state
+  L84_UPDATE_ERR_STATE,
+} l84_update_error_t;
+
+// Find the partition to update. Calls into the bootrom, which may access
+// flash directly: call before core1 is launched.
+void l84_update_init();
+
+// Called from the HID report callbacks
+void l84_update_set_report(const uint8_t *buf, uint16_t len);
+uint16_t l84_update_get_report(uint8_t *buf, uint16_t reqlen);
+
+// Keys changed: hold back sector erases for a while, and for as long as keys
+// are held
+void l84_update_note_activity(uint32_t now_us, bool keys_held);
+// Write received data to flash, verify it. Core0 only.
+void l84_update_task(uint32_t now_us);
+// If the update needs the task to run again, set wakeup_us to that time and
+// return true
+bool l84_update_next_wakeup(uint32_t *wakeup_us);
+void l84_update_print_stats();
+
+#endif /* _LARD84_UPDATE_H */
@@ -6,6 +6,11 @@
 */
 
 #include "class/hid/hid.h"
+#include "lard84_boot.h"
+#include "lard84_diag.h"
+#include "lard84_hid.h"
+#include "lard84_led.h"
+#include "lard84_update.h"
 #include <pico/stdlib.h>
 #include <stdio.h>
 #include <tusb.h>
@@ -17,7 +22,20 @@ void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id,
                            uint16_t bufsize) {
   (void)instance;
 
-  if (report_type == HID_REPORT_TYPE_OUTPUT) {
+  if (report_type == HID_REPORT_TYPE_FEATURE &&
+      report_id == L84_REPORT_ID_DIAG) {
+    l84_diag_select(buffer, bufsize);
+    return;
+  }
+
+  if (report_type == HID_REPORT_TYPE_FEATURE &&
+      report_id == L84_REPORT_ID_UPDATE) {
+    l84_update_set_report(buffer, bufsize);
+    return;
+  }
+
+  if (report_type == HID_REPORT_TYPE_OUTPUT &&
+      (report_id == L84_REPORT_ID_KEYBOARD || report_id == 0)) {
     // Set keyboard LED e.g Capslock, Numlock etc...
     // bufsize should be (at least) 1
     if (bufsize < 1)
@@ -30,6 +48,7 @@ void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id,
     } else {
       printf("CAPSLOCK OFF\n");
     }
+    l84_led_set_caps_lock(kbd_leds & KEYBOARD_LED_CAPSLOCK);
   }
 }
 
@@ -39,16 +58,29 @@ void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id,
 uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id,
                                hid_report_type_t report_type, uint8_t *buffer,
                                uint16_t reqlen) {
-  // TODO not Implemented
   (void)instance;
-  (void)report_id;
-  (void)report_type;
-  (void)buffer;
-  (void)reqlen;
 
+  if (report_type == HID_REPORT_TYPE_FEATURE &&
+      report_id == L84_REPORT_ID_DIAG)
+    return l84_diag_get_report(buffer, reqlen);
+
+  if (report_type == HID_REPORT_TYPE_FEATURE &&
+      report_id == L84_REPORT_ID_UPDATE)
+    return l84_update_get_report(buffer, reqlen);
+
+  // TODO input reports are not implemented
   return 0;
 }
 
+// Invoked when the device is mounted (configured) by the host
+void tud_mount_cb(void) {
+  l84_boot_mark(L84_BOOT_USB_MOUNTED);
+
+  // Send the full state after (re)enumeration, including keys that were
+  // already held before the host was listening
+  l84_hid_invalidate();
+}
+
 #define USB_VID 0xcafe
 #define USB_PID 0x0084
 #define USB_BCD 0x0200
@@ -85,7 +117,31 @@ uint8_t const *tud_descriptor_device_cb(void) {
 // HID Report Descriptor
 //--------------------------------------------------------------------+
 
-uint8_t const desc_hid_report[] = {TUD_HID_REPORT_DESC_KEYBOARD()};
+// Keyboard, media keys, power keys and mouse keys share the interface and its
+// IN endpoint, told apart by report ID. See lard84_hid.c for scheduling.
+uint8_t const desc_hid_report[] = {
+    TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(L84_REPORT_ID_KEYBOARD)),
+    TUD_HID_REPORT_DESC_CONSUMER(HID_REPORT_ID(L84_REPORT_ID_CONSUMER)),
+    TUD_HID_REPORT_DESC_SYSTEM_CONTROL(HID_REPORT_ID(L84_REPORT_ID_SYSTEM)),
+    TUD_HID_REPORT_DESC_MOUSE(HID_REPORT_ID(L84_REPORT_ID_MOUSE)),
+
+    // Diagnostics and firmware update, feature reports only
+    HID_USAGE_PAGE_N(HID_USAGE_PAGE_VENDOR, 2),
+    HID_USAGE(0x01),
+    HID_COLLECTION(HID_COLLECTION_APPLICATION),
+    HID_REPORT_ID(L84_REPORT_ID_DIAG)
+    HID_USAGE(0x02),
+    HID_LOGICAL_MIN(0x00),
+    HID_LOGICAL_MAX_N(0xff, 2),
+    HID_REPORT_SIZE(8),
+    HID_REPORT_COUNT(L84_DIAG_REPORT_SIZE),
+    HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
+    HID_REPORT_ID(L84_REPORT_ID_UPDATE)
+    HID_USAGE(0x03),
+    HID_REPORT_COUNT(L84_UPDATE_REPORT_SIZE),
+    HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
+    HID_COLLECTION_END,
+};
 
 // Invoked when received GET HID REPORT DESCRIPTOR
 // Application return pointer to descriptor
@@ -104,6 +160,9 @@ enum { ITF_NUM_HID, ITF_NUM_TOTAL };
 #define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
 
 #define EPNUM_HID 0x81
+// Input reports are at most 9 bytes with the report ID. CFG_TUD_HID_EP_BUFSIZE
+// is larger, for the diagnostics feature report.
+#define EPSIZE_HID 16
 
 uint8_t const desc_configuration[] = {
     // Config number, interface count, string index, total length, attribute,
@@ -114,8 +173,8 @@ uint8_t const desc_configuration[] = {
     // Innterface number, string index, protocol, report descriptor len, EP In
     // address, size & polling iterval
     TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_KEYBOARD,
-                       sizeof(desc_hid_report), EPNUM_HID,
-                       CFG_TUD_HID_EP_BUFSIZE, 1)};
+                       sizeof(desc_hid_report), EPNUM_HID, EPSIZE_HID,
+                       1)};
 
 // Invoked when received GET CONFIGURATION DESCRIPTOR
 // Application return pointer to descriptor
@@ -0,0 +1,64 @@
+/*
+** file: lard84_test.h
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Minimal checks for the host tests. A failed check prints its location and
+** the test keeps going; main returns L84_TEST_RESULT().
+*/
+
+#ifndef _LARD84_TEST_H
+#define _LARD84_TEST_H
+
+#include "lard84_report.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+static int l84_test_failures = 0;
+
+#define L84_CHECK(cond)                                                        \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);          \
+      l84_test_failures++;                                                     \
+    }                                                                          \
+  } while (0)
+
+#define L84_TEST_RESULT()                                                      \
+  (printf("%s\n", l84_test_failures ? "FAILED" : "OK"), l84_test_failures != 0)
+
+// Check that the keyboard report built from the held keys holds the keycodes
+// given as arguments, in that order, terminated by 0
+static void l84_test_check_report(const char *file, int line, ...) {
+  uint8_t expected[L84_REPORT_N_KEYCODES] = {0};
+  va_list args;
+  va_start(args, line);
+  for (int i = 0, kc; (kc = va_arg(args, int)) != 0; ++i) {
+    expected[i] = (uint8_t)kc;
+  }
+  va_end(args);
+
+  l84_report_t report;
+  l84_report_build(&report, false);
+  if (memcmp(report.keycode, expected, sizeof(expected)) != 0) {
+    printf("%s:%d: report", file, line);
+    for (int i = 0; i < L84_REPORT_N_KEYCODES; ++i)
+      printf(" %02x", report.keycode[i]);
+    printf(", expected");
+    for (int i = 0; i < L84_REPORT_N_KEYCODES; ++i)
+      printf(" %02x", expected[i]);
+    printf("\n");
+    l84_test_failures++;
+  }
+}
+
+#define CHECK_REPORT(...)                                                      \
+  l84_test_check_report(__FILE__, __LINE__, __VA_ARGS__, 0)
+#define CHECK_EMPTY() l84_test_check_report(__FILE__, __LINE__, 0)
+
+#endif /* _LARD84_TEST_H */
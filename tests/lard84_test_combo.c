@@ -0,0 +1,208 @@
+/*
+** file: lard84_test_combo.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Replay key edges through the combo engine, with the default combos, and
+** check the keycodes of the built reports at each step.
+*/
+
+#include "lard84_test.h"
+
+#include "class/hid/hid.h"
+#include "lard84_combo.h"
+#include "lard84_keycodes.h"
+#include "lard84_keyorder.h"
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+#define F10 L84_KEY_INDEX(10, 0)
+#define F11 L84_KEY_INDEX(11, 0)
+#define F12 L84_KEY_INDEX(12, 0)
+// Not part of any combo
+#define KEY_A L84_KEY_INDEX(1, 3)
+
+// Start of each trace, away from 0 to catch mixed up timestamps
+#define T0 1000000u
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+// Key edges and scans at time t, as done by the keymatrix
+static void press(uint8_t key, uint32_t t) {
+  l84_combo_on_press(key, t);
+  l84_combo_task(t);
+}
+
+static void release(uint8_t key, uint32_t t) {
+  l84_combo_on_release(key, t);
+  l84_combo_task(t);
+}
+
+static void scan(uint32_t t) { l84_combo_task(t); }
+
+static uint8_t keycode(uint8_t key) {
+  return (uint8_t)l84_keycode_get(L84_KEY_COL(key), L84_KEY_ROW(key), false);
+}
+
+static void reset() {
+  l84_keyorder_clear();
+  l84_combo_load(l84_default_combos, l84_num_default_combos);
+}
+
+// F10+F11 is part of F10+F11+F12: it waits for the window to close, the
+// larger combo fires as soon as it is complete
+static void test_overlapping() {
+  reset();
+  press(F10, T0);
+  press(F11, T0 + 5000);
+  CHECK_EMPTY();
+  press(F12, T0 + 10000);
+  CHECK_REPORT(HID_KEY_APPLICATION);
+  release(F12, T0 + 60000);
+  CHECK_EMPTY();
+  release(F10, T0 + 61000);
+  release(F11, T0 + 62000);
+  CHECK_EMPTY();
+  L84_CHECK(l84_keyorder_count() == 0);
+
+  // F11+F12 is part of F10+F11+F12 too: it fires when the window closes
+  reset();
+  press(F11, T0);
+  press(F12, T0 + 5000);
+  scan(T0 + L84_COMBO_TERM_US - 1);
+  CHECK_EMPTY();
+  scan(T0 + L84_COMBO_TERM_US);
+  CHECK_REPORT(HID_KEY_PAUSE);
+  release(F11, T0 + 50000);
+  CHECK_EMPTY();
+  release(F12, T0 + 51000);
+  L84_CHECK(l84_keyorder_count() == 0);
+
+  // Keys of a combo may come in any order
+  reset();
+  press(F12, T0);
+  press(F10, T0 + 5000);
+  CHECK_EMPTY();
+  press(F11, T0 + 10000);
+  CHECK_REPORT(HID_KEY_APPLICATION);
+}
+
+// Held-back keys are settled when the window closes, counted from the
+// first press
+static void test_expiry() {
+  reset();
+  press(F10, T0);
+  press(F11, T0 + 30000);
+  scan(T0 + L84_COMBO_TERM_US - 1);
+  CHECK_EMPTY();
+  scan(T0 + L84_COMBO_TERM_US);
+  CHECK_REPORT(HID_KEY_SCROLL_LOCK);
+  // Too late to grow into F10+F11+F12
+  press(F12, T0 + L84_COMBO_TERM_US + 1000);
+  scan(T0 + 2 * L84_COMBO_TERM_US + 1000);
+  CHECK_REPORT(HID_KEY_SCROLL_LOCK, keycode(F12));
+  release(F10, T0 + 200000);
+  CHECK_REPORT(keycode(F12));
+  release(F11, T0 + 201000);
+  release(F12, T0 + 202000);
+  CHECK_EMPTY();
+
+  // A single combo key is forwarded as itself, with no combo
+  reset();
+  press(F10, T0);
+  scan(T0 + L84_COMBO_TERM_US - 1);
+  CHECK_EMPTY();
+  scan(T0 + L84_COMBO_TERM_US);
+  CHECK_REPORT(keycode(F10));
+  release(F10, T0 + 100000);
+  CHECK_EMPTY();
+}
+
+// A combo key tapped within the window is pressed, then released after
+// L84_COMBO_TAP_HOLD_US
+static void test_tap() {
+  reset();
+  press(F10, T0);
+  release(F10, T0 + 20000);
+  CHECK_REPORT(keycode(F10));
+  scan(T0 + 20000 + L84_COMBO_TAP_HOLD_US - 1);
+  CHECK_REPORT(keycode(F10));
+  scan(T0 + 20000 + L84_COMBO_TAP_HOLD_US);
+  CHECK_EMPTY();
+  // The window was closed by the tap: nothing fires later
+  scan(T0 + 2 * L84_COMBO_TERM_US);
+  CHECK_EMPTY();
+  L84_CHECK(l84_keyorder_count() == 0);
+
+  // Pressed and released within one scan
+  reset();
+  l84_combo_on_press(F12, T0);
+  l84_combo_on_release(F12, T0);
+  l84_combo_task(T0);
+  CHECK_REPORT(keycode(F12));
+  scan(T0 + L84_COMBO_TAP_HOLD_US);
+  CHECK_EMPTY();
+}
+
+// A combo completed by a release stays pressed for L84_COMBO_TAP_HOLD_US,
+// even if all of its keys are released at once
+static void test_deferred_release() {
+  reset();
+  press(F10, T0);
+  press(F11, T0 + 5000);
+  l84_combo_on_release(F10, T0 + 20000);
+  l84_combo_on_release(F11, T0 + 20000);
+  l84_combo_task(T0 + 20000);
+  CHECK_REPORT(HID_KEY_SCROLL_LOCK);
+  scan(T0 + 20000 + L84_COMBO_TAP_HOLD_US - 1);
+  CHECK_REPORT(HID_KEY_SCROLL_LOCK);
+  scan(T0 + 20000 + L84_COMBO_TAP_HOLD_US);
+  CHECK_EMPTY();
+  L84_CHECK(l84_keyorder_count() == 0);
+
+  // Pressed again before the deferred release: released, then pressed anew
+  reset();
+  press(F10, T0);
+  release(F10, T0 + 10000);
+  CHECK_REPORT(keycode(F10));
+  press(F10, T0 + 12000);
+  CHECK_EMPTY();
+  scan(T0 + 12000 + L84_COMBO_TERM_US);
+  CHECK_REPORT(keycode(F10));
+  release(F10, T0 + 100000);
+  CHECK_EMPTY();
+}
+
+// Keys not part of any combo are not delayed, and keep the press order
+static void test_other_keys() {
+  reset();
+  press(KEY_A, T0);
+  CHECK_REPORT(keycode(KEY_A));
+  press(F10, T0 + 5000);
+  CHECK_REPORT(keycode(KEY_A));
+  release(KEY_A, T0 + 10000);
+  CHECK_EMPTY();
+  // F10 was pressed first: it goes before A
+  press(KEY_A, T0 + 15000);
+  CHECK_REPORT(keycode(F10), keycode(KEY_A));
+  release(KEY_A, T0 + 20000);
+  release(F10, T0 + 25000);
+  CHECK_EMPTY();
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+int main() {
+  test_overlapping();
+  test_expiry();
+  test_tap();
+  test_deferred_release();
+  test_other_keys();
+  return L84_TEST_RESULT();
+}
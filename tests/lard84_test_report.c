@@ -0,0 +1,160 @@
+/*
+** file: lard84_test_report.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Replay fast typing through the key order and check the keycodes of the
+** built reports, in press order.
+*/
+
+#include "lard84_test.h"
+
+#include "lard84_keycodes.h"
+#include "lard84_keyorder.h"
+#include "lard84_report.h"
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+// Letter keys of the second alpha row, enough to overflow the report
+#define N_TEST_KEYS 8
+#define TEST_ROW 2
+
+// Time of the next key event, 5ms apart: fast typing
+static uint32_t now_us = 0;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static uint8_t key(int i) { return L84_KEY_INDEX(1 + i, TEST_ROW); }
+
+// Keyboard usage of test key i
+static uint8_t kc(int i) {
+  return (uint8_t)l84_keycode_get(1 + i, TEST_ROW, false);
+}
+
+static void press(int i) {
+  l84_keyorder_press(key(i), now_us);
+  now_us += 5000;
+}
+
+static void release(int i) {
+  l84_keyorder_release(key(i));
+  now_us += 5000;
+}
+
+static void reset(l84_rollover_policy_t policy) {
+  l84_keyorder_clear();
+  l84_report_set_rollover_policy(policy);
+}
+
+// Each key pressed before the previous one is released, as in fast typing
+static void test_overlapping() {
+  reset(L84_ROLLOVER_FIRST_PRESSED);
+  CHECK_EMPTY();
+  press(0);
+  CHECK_REPORT(kc(0));
+  press(1);
+  CHECK_REPORT(kc(0), kc(1));
+  release(0);
+  CHECK_REPORT(kc(1));
+  press(2);
+  CHECK_REPORT(kc(1), kc(2));
+  press(3);
+  release(1);
+  CHECK_REPORT(kc(2), kc(3));
+  release(3);
+  CHECK_REPORT(kc(2));
+  // A key pressed again goes after the keys still held
+  press(3);
+  press(1);
+  release(2);
+  CHECK_REPORT(kc(3), kc(1));
+  release(3);
+  release(1);
+  CHECK_EMPTY();
+  L84_CHECK(l84_keyorder_count() == 0);
+}
+
+// More keys held than report slots
+static void test_rollover() {
+  reset(L84_ROLLOVER_FIRST_PRESSED);
+  for (int i = 0; i < N_TEST_KEYS; ++i)
+    press(i);
+  L84_CHECK(l84_keyorder_count() == N_TEST_KEYS);
+  CHECK_REPORT(kc(0), kc(1), kc(2), kc(3), kc(4), kc(5));
+  // Releasing a key frees a slot for the oldest dropped one
+  release(2);
+  CHECK_REPORT(kc(0), kc(1), kc(3), kc(4), kc(5), kc(6));
+  release(0);
+  CHECK_REPORT(kc(1), kc(3), kc(4), kc(5), kc(6), kc(7));
+
+  reset(L84_ROLLOVER_LAST_PRESSED);
+  for (int i = 0; i < N_TEST_KEYS; ++i)
+    press(i);
+  CHECK_REPORT(kc(2), kc(3), kc(4), kc(5), kc(6), kc(7));
+  // Evicted keys come back as the newer ones are released
+  release(7);
+  CHECK_REPORT(kc(1), kc(2), kc(3), kc(4), kc(5), kc(6));
+  release(3);
+  CHECK_REPORT(kc(0), kc(1), kc(2), kc(4), kc(5), kc(6));
+  // Exactly as many keys as slots: nothing evicted
+  press(7);
+  release(0);
+  CHECK_REPORT(kc(1), kc(2), kc(4), kc(5), kc(6), kc(7));
+}
+
+// Releasing a key in the middle keeps the order of the others
+static void test_release_middle() {
+  reset(L84_ROLLOVER_FIRST_PRESSED);
+  for (int i = 0; i < 5; ++i)
+    press(i);
+  release(2);
+  CHECK_REPORT(kc(0), kc(1), kc(3), kc(4));
+  release(1);
+  CHECK_REPORT(kc(0), kc(3), kc(4));
+  press(2);
+  CHECK_REPORT(kc(0), kc(3), kc(4), kc(2));
+  release(4);
+  CHECK_REPORT(kc(0), kc(3), kc(2));
+}
+
+// Repeated events for the same key change nothing
+static void test_duplicates() {
+  reset(L84_ROLLOVER_FIRST_PRESSED);
+  press(0);
+  press(1);
+  uint32_t generation = l84_keyorder_generation();
+  press(0);
+  CHECK_REPORT(kc(0), kc(1));
+  release(2);
+  CHECK_REPORT(kc(0), kc(1));
+  L84_CHECK(l84_keyorder_generation() == generation);
+  release(0);
+  release(0);
+  CHECK_REPORT(kc(1));
+  L84_CHECK(l84_keyorder_count() == 1);
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+int main() {
+  // The test keys must map to distinct keyboard usages
+  for (int i = 0; i < N_TEST_KEYS; ++i) {
+    L84_CHECK(L84_KC_TYPE(l84_keycode_get(1 + i, TEST_ROW, false)) ==
+              L84_KC_TYPE_KEYBOARD);
+    L84_CHECK(kc(i) != 0);
+    for (int j = 0; j < i; ++j)
+      L84_CHECK(kc(i) != kc(j));
+  }
+
+  test_overlapping();
+  test_rollover();
+  test_release_middle();
+  test_duplicates();
+  return L84_TEST_RESULT();
+}
@@ -0,0 +1,153 @@
+/*
+** file: lard84_test_socd.c
+** author: beulard (Matthias Dubouchet)
+** creation date: 18/10/2026
+**
+** Replay opposing direction keys through the key order and check the
+** keycodes of the built reports, in each SOCD mode, with the default pairs.
+*/
+
+#include "lard84_test.h"
+
+#include "class/hid/hid.h"
+#include "lard84_keyorder.h"
+#include "lard84_socd.h"
+
+//-----------------------------------------------------------------------------
+// Static variables
+//-----------------------------------------------------------------------------
+
+#define KEY_LEFT L84_KEY_INDEX(13, 5)
+#define KEY_RIGHT L84_KEY_INDEX(15, 5)
+#define KEY_A L84_KEY_INDEX(1, 3)
+#define KEY_D L84_KEY_INDEX(3, 3)
+// Not part of any pair
+#define KEY_Q L84_KEY_INDEX(1, 2)
+
+// Time of the next key event
+static uint32_t now_us = 0;
+
+//-----------------------------------------------------------------------------
+// Static functions
+//-----------------------------------------------------------------------------
+
+static void press(uint8_t key) {
+  l84_keyorder_press(key, now_us);
+  now_us += 5000;
+}
+
+static void release(uint8_t key) {
+  l84_keyorder_release(key);
+  now_us += 5000;
+}
+
+static void reset(l84_socd_mode_t mode) {
+  l84_keyorder_clear();
+  l84_socd_set_default_pairs();
+  l84_socd_set_mode(mode);
+}
+
+// Both keys of a pair are reported, in press order
+static void test_off() {
+  reset(L84_SOCD_OFF);
+  press(KEY_A);
+  press(KEY_D);
+  CHECK_REPORT(HID_KEY_A, HID_KEY_D);
+  release(KEY_A);
+  CHECK_REPORT(HID_KEY_D);
+}
+
+// The key pressed last wins, the other one comes back when it is released
+static void test_last_input() {
+  reset(L84_SOCD_LAST_INPUT);
+  press(KEY_A);
+  CHECK_REPORT(HID_KEY_A);
+  press(KEY_D);
+  CHECK_REPORT(HID_KEY_D);
+  release(KEY_D);
+  CHECK_REPORT(HID_KEY_A);
+  // Pressed again: wins again
+  press(KEY_D);
+  CHECK_REPORT(HID_KEY_D);
+  release(KEY_A);
+  press(KEY_A);
+  CHECK_REPORT(HID_KEY_A);
+  release(KEY_A);
+  release(KEY_D);
+  CHECK_EMPTY();
+}
+
+// The key pressed first wins until it is released
+static void test_first_input() {
+  reset(L84_SOCD_FIRST_INPUT);
+  press(KEY_A);
+  press(KEY_D);
+  CHECK_REPORT(HID_KEY_A);
+  release(KEY_A);
+  CHECK_REPORT(HID_KEY_D);
+  press(KEY_A);
+  CHECK_REPORT(HID_KEY_D);
+  release(KEY_D);
+  CHECK_REPORT(HID_KEY_A);
+}
+
+// Neither key is reported while both are held
+static void test_neutral() {
+  reset(L84_SOCD_NEUTRAL);
+  press(KEY_A);
+  CHECK_REPORT(HID_KEY_A);
+  press(KEY_D);
+  CHECK_EMPTY();
+  release(KEY_A);
+  CHECK_REPORT(HID_KEY_D);
+}
+
+// Going from one direction to the other between two reports: the old key
+// is gone from the report the new one appears in
+static void test_switch() {
+  reset(L84_SOCD_LAST_INPUT);
+  press(KEY_LEFT);
+  CHECK_REPORT(HID_KEY_ARROW_LEFT);
+  press(KEY_RIGHT);
+  release(KEY_LEFT);
+  CHECK_REPORT(HID_KEY_ARROW_RIGHT);
+
+  // Both released and one pressed again between two reports
+  press(KEY_LEFT);
+  CHECK_REPORT(HID_KEY_ARROW_LEFT);
+  release(KEY_LEFT);
+  release(KEY_RIGHT);
+  press(KEY_RIGHT);
+  CHECK_REPORT(HID_KEY_ARROW_RIGHT);
+}
+
+// Pairs are resolved independently, other keys are left alone
+static void test_pairs() {
+  reset(L84_SOCD_LAST_INPUT);
+  press(KEY_Q);
+  press(KEY_LEFT);
+  press(KEY_A);
+  press(KEY_RIGHT);
+  press(KEY_D);
+  CHECK_REPORT(HID_KEY_Q, HID_KEY_ARROW_RIGHT, HID_KEY_D);
+  release(KEY_RIGHT);
+  CHECK_REPORT(HID_KEY_Q, HID_KEY_ARROW_LEFT, HID_KEY_D);
+
+  // A key belongs to one pair only
+  L84_CHECK(!l84_socd_add_pair(KEY_A, KEY_Q));
+  L84_CHECK(!l84_socd_add_pair(KEY_Q, KEY_Q));
+}
+
+//-----------------------------------------------------------------------------
+// Public API
+//-----------------------------------------------------------------------------
+
+int main() {
+  test_off();
+  test_last_input();
+  test_first_input();
+  test_neutral();
+  test_switch();
+  test_pairs();
+  return L84_TEST_RESULT();
+}
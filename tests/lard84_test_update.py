@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+#
+# file: lard84_test_update.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# Run tools/lard84_update.py against its simulated keyboard: flash an image,
+# check it landed in the other partition and that the keyboard switched to
+# it after the commit, then flash again, the other way.
+#
+# Usage:
+#   lard84_test_update.py
+
+import importlib.util
+import os
+import subprocess
+import sys
+import tempfile
+
+TOOL = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools",
+                    "lard84_update.py")
+
+# Spans a few flash sectors and staging windows, with a partial last sector
+IMAGE_SIZE = 5 * 4096 + 123
+
+failures = 0
+
+
+def check(cond, what):
+    global failures
+    if not cond:
+        print(f"FAILED: {what}")
+        failures += 1
+
+
+def load_tool():
+    sys.dont_write_bytecode = True
+    spec = importlib.util.spec_from_file_location("lard84_update", TOOL)
+    tool = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(tool)
+    return tool
+
+
+def run(flash_path, *args, ok=True):
+    proc = subprocess.run([sys.executable, TOOL, "--mock", flash_path, *args],
+                          capture_output=True, text=True)
+    check((proc.returncode == 0) == ok,
+          f"{' '.join(args)} exited with {proc.returncode}: {proc.stderr}")
+    return proc.stdout
+
+
+def running_partition(flash_path):
+    out = run(flash_path, "status")
+    for line in out.splitlines():
+        if line.startswith("running partition: "):
+            return int(line.split(":")[1].split(",")[0])
+    check(False, f"no running partition in status: {out}")
+    return None
+
+
+def write_image(path, seed):
+    image = bytes((i * 7 + seed) & 0xFF for i in range(IMAGE_SIZE))
+    with open(path, "wb") as f:
+        f.write(image)
+    return image
+
+
+def partition_contents(flash_path, partition, size):
+    with open(flash_path, "rb") as f:
+        f.seek(partition[0])
+        return f.read(size)
+
+
+def main():
+    tool = load_tool()
+    with tempfile.TemporaryDirectory() as tmp:
+        flash_path = os.path.join(tmp, "flash.bin")
+        image_path = os.path.join(tmp, "image.bin")
+        partitions = tool.MockDevice(flash_path).partitions
+
+        # Flash and commit: the keyboard runs the new image from B
+        check(running_partition(flash_path) == 0, "first boot from A")
+        image = write_image(image_path, 1)
+        run(flash_path, "flash", image_path)
+        check(partition_contents(flash_path, partitions[1], IMAGE_SIZE)
+              == image, "image written into B")
+        check(running_partition(flash_path) == 1, "running from B")
+
+        # Flash again: written into A, in two steps
+        image = write_image(image_path, 2)
+        out = run(flash_path, "flash", "--no-commit", image_path)
+        check("into partition 0" in out, f"second image targets A: {out}")
+        check(partition_contents(flash_path, partitions[0], IMAGE_SIZE)
+              == image, "image written into A")
+        check(running_partition(flash_path) == 1, "still running from B")
+        run(flash_path, "commit")
+        check(running_partition(flash_path) == 0, "running from A")
+
+        # An aborted update leaves the running image alone, and a commit
+        # with nothing verified fails
+        run(flash_path, "abort")
+        run(flash_path, "commit", ok=False)
+        check(running_partition(flash_path) == 0, "still running from A")
+
+    print("update: " + ("FAILED" if failures else "OK"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# file: bench_compare.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# Compare benchmark results (see bench/lard84_bench.h) against a baseline.
+# Exits with an error if any stage got slower than the baseline by more than
+# the threshold, or if a stage of the baseline is missing from the results.
+# Without a baseline, or with --update, the results become the baseline.
+#
+# Results are read from a file, from the output of a host benchmark (--run),
+# or from the device over a serial port (--serial, requires pyserial). With
+# several complete runs, the median of each stage is used.
+#
+# A host benchmark is run --runs times. Stages over the threshold are
+# measured again, up to --attempts times in all with a pause in between, and
+# only reported if they regress every time: a busy build machine slows down
+# the benchmark for a while, a regression slows it down every time.
+#
+# Usage:
+#   bench_compare.py --baseline FILE [--threshold PCT] [--update]
+#                    (RESULTS | --run EXE [--runs N] [--attempts N]
+#                     | --serial PORT)
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+# Between measurements of a host benchmark that went over the threshold
+RETRY_PAUSE_S = 2.0
+
+
+def parse(lines):
+    """Return the unit and the median ticks per stage of the complete runs."""
+    unit = None
+    runs = []
+    stages = None
+    for line in lines:
+        words = line.split()
+        if len(words) < 2 or words[0] != "bench":
+            continue
+        if words[1] == "begin" and len(words) == 3:
+            if unit is not None and words[2] != unit:
+                sys.exit(f"results mix {unit} and {words[2]}")
+            unit = words[2]
+            stages = {}
+        elif words[1] == "end" and stages is not None:
+            runs.append(stages)
+            stages = None
+        elif stages is not None and len(words) == 3:
+            stages[words[1]] = int(words[2])
+    if not runs:
+        sys.exit("no complete benchmark run in the results")
+
+    median = {}
+    for run in runs:
+        for name in run:
+            if name not in median:
+                median[name] = round(statistics.median(
+                    r[name] for r in runs if name in r))
+    return unit, median
+
+
+def run_host(exe, runs):
+    lines = []
+    for _ in range(runs):
+        out = subprocess.run([exe], check=True, capture_output=True,
+                             text=True).stdout
+        lines += out.splitlines()
+    return lines
+
+
+def regressed(stages, baseline, threshold):
+    """Return the stages slower than the baseline by more than threshold."""
+    return [name for name, ticks in stages.items()
+            if name in baseline["stages"]
+            and change(baseline["stages"][name], ticks) > threshold]
+
+
+def change(base, ticks):
+    return 100.0 * (ticks - base) / max(base, 1)
+
+
+def read_serial(port, baud, timeout):
+    import serial
+
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        lines = []
+        started = False
+        while True:
+            raw = ser.readline()
+            if not raw:
+                sys.exit(f"timed out waiting for results on {port}")
+            line = raw.decode(errors="replace").strip()
+            started = started or line.startswith("bench begin")
+            if started:
+                lines.append(line)
+            if started and line == "bench end":
+                return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--baseline", required=True)
+    parser.add_argument("--threshold", type=float, default=15.0,
+                        help="allowed slowdown per stage, in percent")
+    parser.add_argument("--update", action="store_true",
+                        help="save the results as the new baseline")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("results", nargs="?")
+    source.add_argument("--run", help="run a host benchmark executable")
+    source.add_argument("--serial", help="read results from a serial port")
+    parser.add_argument("--runs", type=int, default=15,
+                        help="runs of the host benchmark, for the median")
+    parser.add_argument("--attempts", type=int, default=3,
+                        help="measurements of the host benchmark a stage "
+                        "must regress in to fail")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=15.0,
+                        help="serial timeout, in seconds")
+    args = parser.parse_args()
+
+    if args.run:
+        lines = run_host(args.run, args.runs)
+    elif args.serial:
+        lines = read_serial(args.serial, args.baud, args.timeout)
+    else:
+        with open(args.results) as f:
+            lines = f.read().splitlines()
+    unit, stages = parse(lines)
+
+    if args.update or not os.path.exists(args.baseline):
+        with open(args.baseline, "w") as f:
+            json.dump({"unit": unit, "stages": stages}, f, indent=2)
+            f.write("\n")
+        for name, ticks in stages.items():
+            print(f"{name:<14} {ticks:>8} {unit}")
+        print(f"Baseline saved to {args.baseline}")
+        return
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if baseline["unit"] != unit:
+        sys.exit(f"results are in {unit}, baseline in {baseline['unit']}")
+
+    regressions = regressed(stages, baseline, args.threshold)
+    attempt = 1
+    while regressions and args.run and attempt < args.attempts:
+        print("Over the threshold: " + ", ".join(regressions)
+              + ", measuring again")
+        time.sleep(RETRY_PAUSE_S)
+        _, again = parse(run_host(args.run, args.runs))
+        confirmed = regressed(again, baseline, args.threshold)
+        regressions = [name for name in regressions if name in confirmed]
+        # Report the best of the measurements
+        for name, ticks in again.items():
+            stages[name] = min(stages.get(name, ticks), ticks)
+        attempt += 1
+
+    print(f"{'stage':<14} {'baseline':>10} {'current':>10} {'change':>8}"
+          f"  ({unit}, threshold {args.threshold:g}%)")
+    for name, ticks in stages.items():
+        base = baseline["stages"].get(name)
+        if base is None:
+            print(f"{name:<14} {'-':>10} {ticks:>10} {'new':>8}")
+            continue
+        flag = "  REGRESSION" if name in regressions else ""
+        print(f"{name:<14} {base:>10} {ticks:>10} "
+              f"{change(base, ticks):>+7.1f}%{flag}")
+    missing = [name for name in baseline["stages"] if name not in stages]
+    for name in missing:
+        print(f"{name:<14} {baseline['stages'][name]:>10} {'-':>10} "
+              f"{'missing':>8}")
+
+    errors = []
+    if regressions:
+        errors.append(f"{len(regressions)} stage(s) slower than the baseline: "
+                      + ", ".join(regressions))
+    if missing:
+        errors.append(f"{len(missing)} stage(s) missing from the results: "
+                      + ", ".join(missing))
+    if errors:
+        sys.exit("\n".join(errors))
+
+
+if __name__ == "__main__":
+    main()
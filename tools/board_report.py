@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+#
+# file: board_report.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# Compare the firmware built for each board revision: code and data size,
+# size of the generated scan (inlined in l84_keymatrix_poll), and the static
+# cost of a scan. Run by the board_report CMake target after every build.
+#
+# The scan time measured on the device is printed by core1 ("Core1 loop
+# time"); the estimate here only counts what the board description fixes:
+# row and column settle delays and I/O register accesses.
+#
+# Usage:
+#   board_report.py [--output FILE] NAME=ELF=BOARD.json...
+
+import argparse
+import json
+import struct
+import sys
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+# Linker placeholders for the heap and the stacks, not actual usage
+IGNORED_SECTIONS = {".heap", ".stack_dummy", ".stack1_dummy"}
+
+# Functions whose size depends on the board
+SCAN_SYMBOLS = ["l84_keymatrix_poll", "l84_keymatrix_setup"]
+
+
+def read_elf(path):
+    """Return the allocated sections and the function symbol sizes of a
+    32-bit little-endian ELF file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        sys.exit(f"{path}: not a 32-bit little-endian ELF file")
+
+    e_shoff, = struct.unpack_from("<I", data, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    sections = []
+    for i in range(e_shnum):
+        sections.append(struct.unpack_from("<IIIIIIIIII", data,
+                                           e_shoff + i * e_shentsize))
+
+    def name_at(table_offset, offset):
+        end = data.index(b"\0", table_offset + offset)
+        return data[table_offset + offset:end].decode()
+
+    shstr_offset = sections[e_shstrndx][4]
+    alloc = []
+    symbols = {}
+    for (name, sh_type, flags, _, offset, size, link, _, _,
+         entsize) in sections:
+        sec_name = name_at(shstr_offset, name)
+        if flags & SHF_ALLOC and sec_name not in IGNORED_SECTIONS:
+            alloc.append((sec_name, sh_type, flags, size))
+        if sh_type == SHT_SYMTAB:
+            str_offset = sections[link][4]
+            for j in range(size // entsize):
+                st_name, _, st_size, _, _, _ = struct.unpack_from(
+                    "<IIIBBH", data, offset + j * entsize)
+                if st_name:
+                    symbols[name_at(str_offset, st_name)] = st_size
+    return alloc, symbols
+
+
+def sizes(alloc):
+    text = rodata = rwdata = bss = 0
+    for _, sh_type, flags, size in alloc:
+        if sh_type == SHT_NOBITS:
+            bss += size
+        elif flags & SHF_EXECINSTR:
+            text += size
+        elif flags & SHF_WRITE:
+            rwdata += size
+        elif sh_type == SHT_PROGBITS:
+            rodata += size
+    return text, rodata, rwdata, bss
+
+
+def scan_cost(board):
+    n_rows, n_cols = len(board["rows"]), len(board["cols"])
+    # Per column: drive high, read, drive low, then disable and enable each
+    # row input again
+    io = n_cols * (3 + 2 * n_rows)
+    settle_us = (n_cols * board.get("row_settle_us", 1)
+                 + (n_cols - 1) * board["col_settle_us"])
+    return io, settle_us
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--output", help="also write the report to a file")
+    parser.add_argument("boards", nargs="+", metavar="NAME=ELF=BOARD.json")
+    args = parser.parse_args()
+
+    header = (f"{'board':<12} {'text':>8} {'rodata':>8} {'data':>8} "
+              f"{'bss':>8} {'poll':>6} {'setup':>6} {'io/scan':>8} "
+              f"{'settle':>8}")
+    lines = [header, "-" * len(header)]
+    for entry in args.boards:
+        name, elf, board_file = entry.split("=", 2)
+        with open(board_file) as f:
+            board = json.load(f)
+        alloc, symbols = read_elf(elf)
+        text, rodata, rwdata, bss = sizes(alloc)
+        poll, setup = (symbols.get(s, 0) for s in SCAN_SYMBOLS)
+        io, settle_us = scan_cost(board)
+        lines.append(f"{name:<12} {text:>8} {rodata:>8} {rwdata:>8} "
+                     f"{bss:>8} {poll:>6} {setup:>6} {io:>8} "
+                     f"{settle_us:>6}us")
+
+    report = "\n".join(lines) + "\n"
+    print(report, end="")
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(report)
+
+
+if __name__ == "__main__":
+    main()
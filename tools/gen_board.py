@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+#
+# file: gen_board.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# Generate the board headers from a board description file (boards/*.json).
+#
+# lard84_board.h only depends on stdint, like lard84_keymask.h which includes
+# it: matrix dimensions, Fn key position, pin tables and register masks.
+# lard84_board_scan.h holds the matrix scan, unrolled for the board's pins.
+#
+# Usage:
+#   gen_board.py BOARD.json OUTPUT_DIR   generate the headers
+#   gen_board.py --defs BOARD.json       print the compile definitions
+#                                        (semicolon separated, for CMake)
+
+import argparse
+import json
+import os
+import sys
+
+# GPIOs bonded out on the RP2350A of the Stamp, all readable through the
+# single SIO GPIO_IN register
+MAX_PIN = 29
+# Row states are packed into a byte per column
+MAX_ROWS = 8
+
+HEADER = """\
+/*
+** file: {file}
+** author: gen_board.py
+**
+** Generated from {board_file} for board {name}, do not edit.
+** {description}
+*/
+"""
+
+
+def fail(board_file, msg):
+    sys.exit(f"{board_file}: {msg}")
+
+
+def load(board_file):
+    with open(board_file) as f:
+        board = json.load(f)
+
+    for key in ("name", "rows", "cols", "fn_key", "led_pin", "uart",
+                "col_settle_us"):
+        if key not in board:
+            fail(board_file, f"missing '{key}'")
+
+    rows, cols = board["rows"], board["cols"]
+    if not 0 < len(rows) <= MAX_ROWS:
+        fail(board_file, f"between 1 and {MAX_ROWS} rows are supported")
+    if not cols:
+        fail(board_file, "no columns")
+
+    pins = rows + cols + [board["led_pin"], board["uart"]["tx"],
+                          board["uart"]["rx"]]
+    for pin in pins:
+        if not 0 <= pin <= MAX_PIN:
+            fail(board_file, f"pin {pin} out of range [0, {MAX_PIN}]")
+    seen = set()
+    for pin in pins:
+        if pin in seen:
+            fail(board_file, f"pin {pin} is used twice")
+        seen.add(pin)
+
+    fn = board["fn_key"]
+    if not (0 <= fn["col"] < len(cols) and 0 <= fn["row"] < len(rows)):
+        fail(board_file, "Fn key outside of the matrix")
+
+    board.setdefault("description", "")
+    board.setdefault("row_settle_us", 1)
+    return board
+
+
+def mask(pins):
+    m = 0
+    for pin in pins:
+        m |= 1 << pin
+    return m
+
+
+def board_header(board, board_file):
+    rows, cols = board["rows"], board["cols"]
+    out = [HEADER.format(file="lard84_board.h",
+                         board_file=os.path.basename(board_file),
+                         name=board["name"],
+                         description=board["description"])]
+    out.append("#ifndef _LARD84_BOARD_H")
+    out.append("#define _LARD84_BOARD_H")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append(f'#define L84_BOARD_NAME "{board["name"]}"')
+    out.append("")
+    out.append(f"#define L84_BOARD_N_ROWS {len(rows)}")
+    out.append(f"#define L84_BOARD_N_COLS {len(cols)}")
+    out.append("")
+    out.append("// Position of the Fn key")
+    out.append(f"#define L84_BOARD_FN_COL {board['fn_key']['col']}")
+    out.append(f"#define L84_BOARD_FN_ROW {board['fn_key']['row']}")
+    out.append("")
+    out.append(f"#define L84_BOARD_LED_PIN {board['led_pin']}")
+    out.append("")
+    out.append("// GPIO masks, bit n for pin n")
+    out.append(f"#define L84_BOARD_ROW_MASK 0x{mask(rows):08x}u")
+    out.append(f"#define L84_BOARD_COL_MASK 0x{mask(cols):08x}u")
+    out.append("")
+    out.append("// Time for a column to go low before the next one is driven")
+    out.append(f"#define L84_BOARD_COL_SETTLE_US {board['col_settle_us']}")
+    out.append("// Time for the rows to follow a column driven high before they "
+               "are read")
+    out.append(f"#define L84_BOARD_ROW_SETTLE_US {board['row_settle_us']}")
+    out.append("")
+    out.append("// GPIO pin of each row and column")
+    out.append("static const uint8_t l84_board_row_pin[L84_BOARD_N_ROWS] = {"
+               + ", ".join(str(p) for p in rows) + "};")
+    out.append("static const uint8_t l84_board_col_pin[L84_BOARD_N_COLS] = {"
+               + ", ".join(str(p) for p in cols) + "};")
+    out.append("")
+    out.append("#endif /* _LARD84_BOARD_H */")
+    return "\n".join(out) + "\n"
+
+
+def scan_header(board, board_file):
+    rows, cols = board["rows"], board["cols"]
+    out = [HEADER.format(file="lard84_board_scan.h",
+                         board_file=os.path.basename(board_file),
+                         name=board["name"],
+                         description=board["description"])]
+    out.append("#ifndef _LARD84_BOARD_SCAN_H")
+    out.append("#define _LARD84_BOARD_SCAN_H")
+    out.append("")
+    out.append('#include "hardware/structs/pads_bank0.h"')
+    out.append('#include "hardware/structs/sio.h"')
+    out.append('#include "hardware/sync.h"')
+    out.append('#include "lard84_board.h"')
+    out.append('#include "pico/time.h"')
+    out.append("")
+
+    # Row inputs are enabled at setup, and reset after reading each column,
+    # see Errata E9 in lard84_keymatrix.c
+    for name, op in (("enable", "hw_set_bits"), ("disable", "hw_clear_bits")):
+        out.append(f"static inline void l84_board_rows_input_{name}() {{")
+        for pin in rows:
+            out.append(f"  {op}(&pads_bank0_hw->io[{pin}], "
+                       "PADS_BANK0_GPIO0_IE_BITS);")
+        out.append("}")
+        out.append("")
+
+    out.append("// Row bits of a column, bit r set if row r reads high")
+    out.append("static inline uint8_t l84_board_row_bits(uint32_t in) {")
+    terms = [f"(((in >> {pin}) & 1u) << {r})" for r, pin in enumerate(rows)]
+    out.append("  return (uint8_t)(" + " |\n                   ".join(terms)
+               + ");")
+    out.append("}")
+    out.append("")
+
+    out.append("// Drive each column high in turn and read all rows at once.")
+    out.append("// col_rows[col] receives the row bits of the column.")
+    out.append("// Row inputs must be enabled, see "
+               "l84_board_rows_input_enable.")
+    out.append("static inline void l84_board_scan("
+               "uint8_t col_rows[L84_BOARD_N_COLS]) {")
+    out.append("  uint32_t in;")
+    for c, pin in enumerate(cols):
+        out.append("")
+        out.append(f"  // col{c + 1}, pin {pin}")
+        out.append(f"  sio_hw->gpio_set = 1u << {pin};")
+        out.append("  busy_wait_us_32(L84_BOARD_ROW_SETTLE_US);")
+        out.append("  in = sio_hw->gpio_in;")
+        out.append(f"  sio_hw->gpio_clr = 1u << {pin};")
+        # Release rows latched high by this column before the next one
+        out.append("  l84_board_rows_input_disable();")
+        out.append("  l84_board_rows_input_enable();")
+        out.append(f"  col_rows[{c}] = l84_board_row_bits(in);")
+        # Nothing is driven after the last column until the next scan
+        if c != len(cols) - 1:
+            out.append("  busy_wait_us_32(L84_BOARD_COL_SETTLE_US);")
+    out.append("}")
+    out.append("")
+    out.append("#endif /* _LARD84_BOARD_SCAN_H */")
+    return "\n".join(out) + "\n"
+
+
+def write(path, text):
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--defs", action="store_true",
+                        help="print the compile definitions and exit")
+    parser.add_argument("board_file")
+    parser.add_argument("output_dir", nargs="?")
+    args = parser.parse_args()
+
+    board = load(args.board_file)
+
+    if args.defs:
+        print(f"PICO_DEFAULT_UART_TX_PIN={board['uart']['tx']};"
+              f"PICO_DEFAULT_UART_RX_PIN={board['uart']['rx']}")
+        return
+
+    if not args.output_dir:
+        parser.error("output_dir is required")
+    os.makedirs(args.output_dir, exist_ok=True)
+    write(os.path.join(args.output_dir, "lard84_board.h"),
+          board_header(board, args.board_file))
+    write(os.path.join(args.output_dir, "lard84_board_scan.h"),
+          scan_header(board, args.board_file))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+#
+# file: lard84_diag.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# Read diagnostics from a lard84 keyboard over its vendor-defined HID feature
+# report, see src/lard84_diag.h.
+#
+# Requires the hidapi bindings: pip install hidapi
+#
+# Usage:
+#   lard84_diag.py keystats [--chatter]
+#   lard84_diag.py boot
+#   lard84_diag.py stack
+
+import argparse
+import struct
+import sys
+
+import hid
+
+USB_VID = 0xCAFE
+USB_PID = 0x0084
+
+REPORT_ID_DIAG = 0x10
+REPORT_SIZE = 63
+HEADER_SIZE = 8
+
+TOPIC_KEYSTATS = 1
+TOPIC_BOOT = 2
+TOPIC_STACK = 3
+
+# Same as L84_STACK_MIN_FREE
+STACK_MIN_FREE = 256
+
+# Same order as l84_boot_phase_t
+BOOT_PHASES = [
+    "main",
+    "stdio",
+    "core1 launch",
+    "gpio setup",
+    "matrix ready",
+    "usb init",
+    "usb mounted",
+    "first report",
+]
+
+
+def open_device():
+    for info in hid.enumerate(USB_VID, USB_PID):
+        # The diagnostics report lives on the keyboard interface
+        dev = hid.device()
+        dev.open_path(info["path"])
+        return dev
+    sys.exit("lard84 not found")
+
+
+def read_topic(dev, topic):
+    """Select the topic, then read pages until the whole topic is in."""
+    select = bytes([REPORT_ID_DIAG, topic, 0, 0])
+    dev.send_feature_report(select + bytes(REPORT_SIZE + 1 - len(select)))
+
+    data = b""
+    size = None
+    while size is None or len(data) < size:
+        report = bytes(dev.get_feature_report(REPORT_ID_DIAG, REPORT_SIZE + 1))
+        # Skip the report ID
+        report = report[1:]
+        r_topic, _, page, r_size, n = struct.unpack_from("<BBHHB", report)
+        if r_topic != topic:
+            sys.exit(f"unexpected topic {r_topic}")
+        if n == 0:
+            break
+        size = r_size
+        data += report[HEADER_SIZE : HEADER_SIZE + n]
+    return data
+
+
+def keystats(dev, args):
+    data = read_topic(dev, TOPIC_KEYSTATS)
+    n_rows, n_cols = data[0], data[1]
+    press = {}
+    chatter = {}
+    for col in range(n_cols):
+        for row in range(n_rows):
+            # Same as L84_KEY_INDEX
+            key = col * n_rows + row
+            p, c = struct.unpack_from("<IH", data, 4 + 6 * key)
+            press[col, row] = p
+            chatter[col, row] = c
+
+    counts = chatter if args.chatter else press
+    print("Chatter events" if args.chatter else "Key presses")
+    width = max(len(str(v)) for v in counts.values()) + 1
+    print("     " + "".join(f"{col + 1:>{width}}" for col in range(n_cols)))
+    for row in range(n_rows):
+        line = "".join(
+            f"{counts[col, row] or '.':>{width}}" for col in range(n_cols)
+        )
+        print(f"row{row + 1} {line}")
+
+    print(f"Total: {sum(press.values())} presses, "
+          f"{sum(chatter.values())} chatter events")
+
+
+def boot(dev, args):
+    data = read_topic(dev, TOPIC_BOOT)
+    n_phases = data[0]
+    prev = 0
+    for phase in range(n_phases):
+        (t,) = struct.unpack_from("<I", data, 4 + 4 * phase)
+        name = BOOT_PHASES[phase] if phase < len(BOOT_PHASES) else str(phase)
+        if t == 0xFFFFFFFF:
+            print(f"{name:>14}: not reached")
+            continue
+        print(f"{name:>14}: {t / 1000:9.3f} ms  (+{(t - prev) / 1000:.3f} ms)")
+        prev = t
+
+
+def stack(dev, args):
+    data = read_topic(dev, TOPIC_STACK)
+    for core in range(2):
+        size, used = struct.unpack_from("<II", data, 8 * core)
+        low = "  LOW" if size - used < STACK_MIN_FREE else ""
+        print(f"core{core}: {used:>6} / {size} bytes used "
+              f"({100 * used // max(size, 1)}%){low}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("keystats", help="per-key press and chatter counts")
+    p.add_argument("--chatter", action="store_true",
+                   help="show chatter events instead of presses")
+    p.set_defaults(func=keystats)
+    p = sub.add_parser("boot", help="boot phase timestamps")
+    p.set_defaults(func=boot)
+    p = sub.add_parser("stack", help="stack high-water marks of both cores")
+    p.set_defaults(func=stack)
+    args = parser.parse_args()
+
+    dev = open_device()
+    try:
+        args.func(dev, args)
+    finally:
+        dev.close()
+
+
+if __name__ == "__main__":
+    main()
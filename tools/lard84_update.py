@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+#
+# file: lard84_update.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# Update the firmware of a lard84 keyboard over USB, see src/lard84_update.h.
+# The image (lard84-fw-<board>.bin) is written into the partition the
+# keyboard is not running from, while it keeps working, then the keyboard
+# reboots into it.
+#
+# With --mock FILE, talks to a simulated keyboard instead, whose flash is the
+# given file (created if needed). Its state is kept next to it in FILE.json:
+# a commit takes effect on the next run, like the reboot of the keyboard, so
+# successive updates switch between A and B.
+#
+# Requires the hidapi bindings, except with --mock: pip install hidapi
+#
+# Usage:
+#   lard84_update.py [--mock FILE] status
+#   lard84_update.py [--mock FILE] flash [--no-commit] IMAGE.bin
+#   lard84_update.py [--mock FILE] commit
+#   lard84_update.py [--mock FILE] abort
+
+import argparse
+import hashlib
+import json
+import os
+import struct
+import sys
+import time
+
+USB_VID = 0xCAFE
+USB_PID = 0x0084
+
+REPORT_ID_UPDATE = 0x11
+REPORT_SIZE = 63
+HEADER_SIZE = 6
+PAYLOAD_SIZE = REPORT_SIZE - HEADER_SIZE
+
+# Same as the staging buffer in lard84_update.c: data beyond the written
+# count plus this is dropped by the keyboard
+WINDOW_SIZE = 2 * 4096
+
+# Give up when the keyboard makes no progress for this long, in seconds
+TIMEOUT = 10.0
+
+CMD_BEGIN = 1
+CMD_DATA = 2
+CMD_COMMIT = 3
+CMD_ABORT = 4
+
+# Same order as l84_update_state_t and l84_update_error_t
+STATES = ["idle", "receiving", "verifying", "ready", "committed", "failed"]
+ERRORS = [
+    "none",
+    "not booted from an A/B partition",
+    "image too large for the partition",
+    "flash write failed",
+    "image hash mismatch",
+    "unexpected command",
+]
+RECEIVING, VERIFYING, READY, COMMITTED, FAILED = 1, 2, 3, 4, 5
+NO_PARTITION = 0xFF
+
+PARTITIONS_FILE = os.path.join(os.path.dirname(__file__), "..", "boards",
+                               "partitions.json")
+
+
+class HidDevice:
+    def __init__(self):
+        import hid
+
+        for info in hid.enumerate(USB_VID, USB_PID):
+            # The update report lives on the keyboard interface
+            self.dev = hid.device()
+            self.dev.open_path(info["path"])
+            return
+        sys.exit("lard84 not found")
+
+    def set_report(self, data):
+        report = bytes([REPORT_ID_UPDATE]) + data
+        self.dev.send_feature_report(report + bytes(REPORT_SIZE + 1 -
+                                                    len(report)))
+
+    def get_report(self):
+        report = bytes(self.dev.get_feature_report(REPORT_ID_UPDATE,
+                                                   REPORT_SIZE + 1))
+        # Skip the report ID
+        return report[1:]
+
+    def close(self):
+        self.dev.close()
+
+
+class MockDevice:
+    """The keyboard side of the protocol, over a flash image in a file.
+    Partitions are laid out from boards/partitions.json, back to back after
+    the partition table. The flash is written one sector per status request,
+    to exercise the flow control."""
+
+    FLASH_SECTOR_SIZE = 4096
+    TABLE_SIZE = 2 * FLASH_SECTOR_SIZE
+
+    def __init__(self, path):
+        with open(PARTITIONS_FILE) as f:
+            table = json.load(f)
+        self.partitions = []
+        offset = self.TABLE_SIZE
+        for part in table["partitions"]:
+            size = int(part["size"].rstrip("K")) * 1024
+            self.partitions.append((offset, size))
+            offset += size
+
+        self.path = path
+        self.state_path = path + ".json"
+        if not os.path.exists(path):
+            with open(path, "wb") as f:
+                f.write(b"\xff" * offset)
+        saved = {"running": 0, "state": 0, "error": 0, "size": 0,
+                 "hash": "", "written": 0}
+        if os.path.exists(self.state_path):
+            with open(self.state_path) as f:
+                saved.update(json.load(f))
+        self.running = saved["running"]
+        self.state = saved["state"]
+        self.error = saved["error"]
+        self.size = saved["size"]
+        self.hash = bytes.fromhex(saved["hash"])
+        # The staging buffer does not survive between runs
+        self.received = self.written = saved["written"]
+        if self.state == COMMITTED:
+            self.running = 1 - self.running
+            self.state = self.error = self.size = 0
+            self.received = self.written = 0
+        self.target = 1 - self.running
+        self.staging = bytearray()
+
+    def fail(self, error):
+        self.state, self.error = FAILED, error
+
+    def set_report(self, data):
+        cmd, n, arg = struct.unpack_from("<BBI", data)
+        payload = bytes(data[HEADER_SIZE:HEADER_SIZE + n])
+        if cmd == CMD_BEGIN and self.state != COMMITTED:
+            if self.state in (RECEIVING, VERIFYING):
+                return self.fail(5)
+            if arg == 0 or arg > self.partitions[self.target][1]:
+                return self.fail(2)
+            self.state, self.error = RECEIVING, 0
+            self.size, self.hash = arg, payload
+            self.received = self.written = 0
+            self.staging = bytearray()
+        elif cmd == CMD_DATA:
+            if (self.state != RECEIVING or arg != self.received
+                    or n > self.size - self.received
+                    or self.received + n > self.written + WINDOW_SIZE):
+                return
+            self.staging += payload
+            self.received += n
+        elif cmd == CMD_COMMIT and self.state != COMMITTED:
+            if self.state != READY:
+                return self.fail(5)
+            self.state = COMMITTED
+        elif cmd == CMD_ABORT and self.state != COMMITTED:
+            self.state, self.error = 0, 0
+
+    def step(self):
+        if self.state == RECEIVING:
+            n = min(self.FLASH_SECTOR_SIZE, self.size - self.written)
+            if self.received - self.written < n:
+                return
+            offset = self.partitions[self.target][0] + self.written
+            # Whole sectors, padded like the keyboard does
+            with open(self.path, "r+b") as f:
+                f.seek(offset)
+                f.write(self.staging[:n].ljust(self.FLASH_SECTOR_SIZE,
+                                               b"\xff"))
+            del self.staging[:n]
+            self.written += n
+            if self.written == self.size:
+                self.state = VERIFYING
+        elif self.state == VERIFYING:
+            with open(self.path, "rb") as f:
+                f.seek(self.partitions[self.target][0])
+                digest = hashlib.sha256(f.read(self.size)).digest()
+            if digest == self.hash:
+                self.state = READY
+            else:
+                self.fail(4)
+
+    def get_report(self):
+        self.step()
+        report = struct.pack("<BBBBIIII", self.state, self.error,
+                             self.running, self.target,
+                             self.partitions[self.target][1], self.size,
+                             self.received, self.written)
+        return report.ljust(REPORT_SIZE, b"\0")
+
+    def close(self):
+        with open(self.state_path, "w") as f:
+            json.dump({"running": self.running, "state": self.state,
+                       "error": self.error, "size": self.size,
+                       "hash": self.hash.hex(), "written": self.written}, f)
+
+
+def command(dev, cmd, arg=0, payload=b""):
+    dev.set_report(struct.pack("<BBI", cmd, len(payload), arg) + payload)
+
+
+def get_status(dev):
+    (state, error, running, target, part_size, size, received,
+     written) = struct.unpack_from("<BBBBIIII", dev.get_report())
+    return {
+        "state": state,
+        "error": error,
+        "running": running,
+        "target": target,
+        "partition size": part_size,
+        "size": size,
+        "received": received,
+        "written": written,
+    }
+
+
+def partition_name(index):
+    return "none" if index == NO_PARTITION else str(index)
+
+
+def check_failed(st):
+    if st["state"] == FAILED:
+        sys.exit(f"update failed: {ERRORS[st['error']]}")
+
+
+def status(dev, args):
+    st = get_status(dev)
+    print(f"state: {STATES[st['state']]}"
+          + (f" ({ERRORS[st['error']]})" if st["state"] == FAILED else ""))
+    print(f"running partition: {partition_name(st['running'])}, "
+          f"target partition: {partition_name(st['target'])} "
+          f"({st['partition size'] // 1024} KB)")
+    if st["size"]:
+        print(f"image: {st['received']}/{st['size']} bytes received, "
+              f"{st['written']} written")
+
+
+def flash(dev, args):
+    with open(args.image, "rb") as f:
+        image = f.read()
+    digest = hashlib.sha256(image).digest()
+
+    st = get_status(dev)
+    if st["target"] == NO_PARTITION:
+        sys.exit(f"update failed: {ERRORS[1]}")
+    if st["state"] in (RECEIVING, VERIFYING):
+        command(dev, CMD_ABORT)
+    print(f"Writing {len(image)} bytes into partition {st['target']}")
+    command(dev, CMD_BEGIN, len(image), digest)
+
+    start = time.monotonic()
+    last_progress = (None, start)
+    while True:
+        st = get_status(dev)
+        check_failed(st)
+        if st["state"] != RECEIVING:
+            break
+
+        progress = (st["received"], st["written"])
+        now = time.monotonic()
+        if progress != last_progress[0]:
+            last_progress = (progress, now)
+        elif now - last_progress[1] > TIMEOUT:
+            sys.exit("update failed: the keyboard stopped responding")
+
+        # Resend from what the keyboard has, up to what it can take
+        offset = st["received"]
+        end = min(len(image), st["written"] + WINDOW_SIZE)
+        while offset < end:
+            chunk = image[offset:min(offset + PAYLOAD_SIZE, end)]
+            command(dev, CMD_DATA, offset, chunk)
+            offset += len(chunk)
+        print(f"\r{100 * st['written'] // len(image):3}%", end="", flush=True)
+
+    while st["state"] == VERIFYING:
+        st = get_status(dev)
+        check_failed(st)
+    print(f"\rWritten and verified in {time.monotonic() - start:.1f}s")
+
+    if args.no_commit:
+        print("Run 'lard84_update.py commit' to switch to the new firmware")
+        return
+    commit(dev, args)
+
+
+def commit(dev, args):
+    command(dev, CMD_COMMIT)
+    st = get_status(dev)
+    check_failed(st)
+    print(f"Rebooting into partition {st['target']}")
+
+
+def abort(dev, args):
+    command(dev, CMD_ABORT)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--mock", metavar="FILE",
+                        help="simulated keyboard with its flash in FILE")
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("status", help="update state and partitions")
+    p.set_defaults(func=status)
+    p = sub.add_parser("flash", help="write a new firmware image")
+    p.add_argument("image", help="firmware image, lard84-fw-<board>.bin")
+    p.add_argument("--no-commit", action="store_true",
+                   help="write and verify, but keep the running firmware")
+    p.set_defaults(func=flash)
+    p = sub.add_parser("commit", help="reboot into a verified image")
+    p.set_defaults(func=commit)
+    p = sub.add_parser("abort", help="drop the update in progress")
+    p.set_defaults(func=abort)
+    args = parser.parse_args()
+
+    dev = MockDevice(args.mock) if args.mock else HidDevice()
+    try:
+        args.func(dev, args)
+    finally:
+        dev.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+#
+# file: ram_budget.py
+# author: beulard (Matthias Dubouchet)
+# creation date: 18/10/2026
+#
+# RAM budget of a firmware image, per module, from the GNU ld map file.
+# Modules are the lard84_*.c sources, TinyUSB, the rest of the pico-sdk, the
+# C libraries, and the stacks and heap reserved by the linker script.
+# Flash usage is listed too: constant tables (e.g. the keymap) live there,
+# and initialised RAM (.data, scratch) is also stored in flash.
+#
+# Usage:
+#   ram_budget.py [--budget BYTES] [--output FILE] FIRMWARE.elf.map
+
+import argparse
+import os
+import re
+import sys
+
+RAM_START, RAM_END = 0x20000000, 0x20082000
+FLASH_START, FLASH_END = 0x10000000, 0x14000000
+
+# Output sections in RAM without an image in flash
+NOLOAD_SECTIONS = {".bss", ".heap", ".stack_dummy", ".stack1_dummy",
+                   ".uninitialized_data"}
+
+# Largest RAM symbols listed after the per-module table
+N_TOP_SYMBOLS = 15
+
+OUTPUT_RE = re.compile(r"^(\.\S+|\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+))?")
+INPUT_RE = re.compile(r"^ (\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s*(.*))?$")
+CONT_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s*(.*)$")
+
+
+def module_of(out_section, obj):
+    if out_section == ".stack_dummy":
+        return "core0 stack"
+    if out_section == ".stack1_dummy":
+        return "core1 stack"
+    if out_section == ".heap":
+        return "heap"
+    if not obj:
+        return "padding"
+    name = os.path.basename(obj)
+    m = re.match(r"lard84_(\w+)\.c\.obj$", name)
+    if m:
+        return m.group(1)
+    if "tinyusb" in obj:
+        return "tinyusb"
+    if "pico-sdk" in obj or "pico_" in obj or "hardware_" in obj or \
+            "boot_stage2" in obj:
+        return "pico-sdk"
+    if obj.endswith(")") or ".a(" in obj:
+        return "libc/libgcc"
+    return name
+
+
+def parse(path):
+    """Yield (output section, input section, address, size, object)."""
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    try:
+        start = lines.index("Linker script and memory map")
+    except ValueError:
+        sys.exit(f"{path}: not a GNU ld map file")
+
+    out_section = None
+    pending = None
+    for line in lines[start + 1:]:
+        if pending:
+            m = CONT_RE.match(line)
+            if m:
+                yield (out_section, pending, int(m.group(1), 16),
+                       int(m.group(2), 16), m.group(3).strip())
+            pending = None
+            continue
+        if not line.strip():
+            continue
+        if not line[0].isspace():
+            m = OUTPUT_RE.match(line)
+            out_section = m.group(1)
+            continue
+        m = INPUT_RE.match(line)
+        if not m or m.group(1).startswith("*(") or out_section is None:
+            continue
+        if m.group(2) is None:
+            # Long input section names continue on the next line
+            pending = m.group(1)
+            continue
+        yield (out_section, m.group(1), int(m.group(2), 16),
+               int(m.group(3), 16), m.group(4).strip())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--budget", type=int, default=0,
+                        help="fail if static RAM exceeds this many bytes")
+    parser.add_argument("--output", help="also write the report to a file")
+    parser.add_argument("map_file")
+    args = parser.parse_args()
+
+    ram = {}
+    flash = {}
+    symbols = []
+    for out_section, section, addr, size, obj in parse(args.map_file):
+        if not size or out_section == "/DISCARD/":
+            continue
+        module = module_of(out_section, obj)
+        if RAM_START <= addr < RAM_END:
+            ram[module] = ram.get(module, 0) + size
+            if out_section not in NOLOAD_SECTIONS:
+                flash[module] = flash.get(module, 0) + size
+            name = re.sub(r"^\.(bss|data|scratch_[xy]|uninitialized_data)\.",
+                          "", section)
+            symbols.append((size, name, module))
+        elif FLASH_START <= addr < FLASH_END:
+            flash[module] = flash.get(module, 0) + size
+
+    total_ram = sum(ram.values())
+    total_flash = sum(flash.values())
+    out = [f"RAM budget of {os.path.basename(args.map_file)}",
+           f"{'module':<16} {'RAM':>8} {'flash':>8}"]
+    for module in sorted(set(ram) | set(flash),
+                         key=lambda m: (-ram.get(m, 0), m)):
+        out.append(f"{module:<16} {ram.get(module, 0):>8} "
+                   f"{flash.get(module, 0):>8}")
+    out.append(f"{'total':<16} {total_ram:>8} {total_flash:>8}")
+    out.append(f"RAM free: {RAM_END - RAM_START - total_ram} bytes")
+    out.append("")
+    out.append("Largest RAM symbols:")
+    for size, name, module in sorted(symbols, reverse=True)[:N_TOP_SYMBOLS]:
+        out.append(f"{size:>8} {name} ({module})")
+
+    report = "\n".join(out) + "\n"
+    print(report, end="")
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(report)
+
+    if args.budget and total_ram > args.budget:
+        sys.exit(f"static RAM {total_ram} bytes over the budget of "
+                 f"{args.budget} bytes")
+
+
+if __name__ == "__main__":
+    main()
@@ -98,7 +98,9 @@
  #define CFG_TUD_VENDOR            0
  
  // HID buffer size Should be sufficient to hold ID (if any) + Data
- #define CFG_TUD_HID_EP_BUFSIZE    16
+ // Also used for GET/SET_REPORT on the control endpoint, sized for the
+ // diagnostics feature report (see lard84_diag.h)
+ #define CFG_TUD_HID_EP_BUFSIZE    64
  
  #ifdef __cplusplus
   }